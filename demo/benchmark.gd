@@ -0,0 +1,231 @@
+extends SceneTree
+
+# Headless import benchmark. Imports each level several times, then
+# compares the median timings, peak RSS and output size against a stored
+# baseline and exits non-zero if any of them regressed. The structure of
+# the output, the counts in STRUCTURE_COUNTS, must match the baseline
+# exactly, so an import that got faster by dropping geometry fails too.
+#
+#   godot --headless --path demo -s res://benchmark.gd -- \
+#       --lvl=/path/to/geo1.lvl --lvl=/path/to/kas2.lvl --runs=5
+#   godot --headless --path demo -s res://benchmark.gd -- \
+#       --synthetic=terrain_size:512,instance_count:4000
+#
+# Arguments after "--":
+#   --lvl=PATH          level to import, may be repeated
+#   --synthetic=PARAMS  generated world to import, may be repeated. PARAMS
+#                       is a comma separated list of key:value sizes from
+#                       synthetic_world.hpp, or "default". Synthetic
+#                       worlds go through the same entity class, model,
+#                       collision, material, texture and batching code as
+#                       levels; only the skydome has nothing to import.
+#   --runs=N            imports of each level or world, 3 by default
+#   --threads=N         importer thread_count, 0 (every processor) by default
+#   --options=OPTIONS   further import options, see import_options.hpp, as a
+#                       comma separated list of key:value, e.g.
+#                       batch_instances:8,merge_collision:true. Record the
+#                       baseline with the same options.
+#   --baseline=PATH     res://benchmark_baseline.json by default. Levels
+#                       and worlds missing from it are added from this
+#                       run, creating it if needed, and pass
+#   --update-baseline   write the results as the new baseline and pass
+#   --tolerance=F       allowed fractional slowdown, 0.15 by default
+#   --min-usec=N        phases shorter than this in the baseline are too
+#                       noisy to compare, 10000 by default
+#   --out=PATH          also write the results as JSON
+#
+# Peak RSS is read from /proc/self/status where available, otherwise
+# Godot's own peak memory usage is used. It covers the whole process, so
+# only the first level's figure is independent of the levels before it.
+
+const OUTPUT_ROOT = "user://lvlimport_benchmark"
+# Report counts describing what was imported, recorded as "count.<name>"
+const STRUCTURE_COUNTS = [
+	"instances", "entity_classes", "materials", "textures", "surfaces",
+	"vertices", "triangles", "collision_bodies", "collision_hulls",
+]
+
+var lvl_paths: Array = []
+var synthetic_params: Array = []
+var runs := 3
+var thread_count := 0
+var import_options := {}
+var baseline_path := "res://benchmark_baseline.json"
+var update_baseline := false
+var tolerance := 0.15
+var min_usec := 10000
+var out_path := ""
+
+func _initialize():
+	if not parse_args():
+		quit(2)
+		return
+	var results := {}
+	for lvl_path in lvl_paths:
+		var name = lvl_path.get_file().get_basename()
+		results[name] = benchmark(name, func(scene_dir, options): return LVLImport.import_lvl(lvl_path, scene_dir, options))
+	for params in synthetic_params:
+		var name = "synthetic_" + params
+		var sizes = parse_synthetic_params(params)
+		results[name] = benchmark(name, func(scene_dir, options): return LVLImport.import_synthetic(scene_dir, sizes, options))
+	print(JSON.stringify(results, "\t"))
+	if out_path != "":
+		save_json(out_path, results)
+
+	if update_baseline:
+		save_json(baseline_path, results)
+		print("Wrote baseline ", baseline_path)
+		quit(0)
+		return
+	var baseline = {}
+	if FileAccess.file_exists(baseline_path):
+		baseline = JSON.parse_string(FileAccess.get_file_as_string(baseline_path))
+		if not baseline is Dictionary:
+			printerr("Malformed baseline ", baseline_path)
+			quit(2)
+			return
+	var added := false
+	for name in results:
+		if not baseline.has(name):
+			print("No baseline for ", name, "; recording this run in ", baseline_path)
+			baseline[name] = results[name]
+			added = true
+	if added:
+		save_json(baseline_path, baseline)
+	var regressions := compare(baseline, results)
+	for regression in regressions:
+		printerr("REGRESSION ", regression)
+	if regressions.is_empty():
+		print("No regressions against ", baseline_path)
+		quit(0)
+	else:
+		quit(1)
+
+func parse_args() -> bool:
+	for arg in OS.get_cmdline_user_args():
+		var value = arg.substr(arg.find("=") + 1)
+		if arg.begins_with("--lvl="):
+			lvl_paths.push_back(value)
+		elif arg.begins_with("--synthetic="):
+			synthetic_params.push_back(value)
+		elif arg.begins_with("--runs="):
+			runs = maxi(value.to_int(), 1)
+		elif arg.begins_with("--threads="):
+			thread_count = maxi(value.to_int(), 0)
+		elif arg.begins_with("--options="):
+			import_options = parse_import_options(value)
+		elif arg.begins_with("--baseline="):
+			baseline_path = value
+		elif arg == "--update-baseline":
+			update_baseline = true
+		elif arg.begins_with("--tolerance="):
+			tolerance = value.to_float()
+		elif arg.begins_with("--min-usec="):
+			min_usec = value.to_int()
+		elif arg.begins_with("--out="):
+			out_path = value
+		else:
+			printerr("Unknown argument ", arg)
+			return false
+	if lvl_paths.is_empty() and synthetic_params.is_empty():
+		printerr("Nothing to benchmark; pass one or more --lvl=PATH or --synthetic=PARAMS")
+		return false
+	return true
+
+func parse_synthetic_params(params: String) -> Dictionary:
+	var sizes := {}
+	if params == "default":
+		return sizes
+	for pair in params.split(",", false):
+		sizes[pair.get_slice(":", 0)] = pair.get_slice(":", 1).to_int()
+	return sizes
+
+func parse_import_options(options: String) -> Dictionary:
+	var parsed := {}
+	for pair in options.split(",", false):
+		var value = pair.get_slice(":", 1)
+		if value == "true" or value == "false":
+			parsed[pair.get_slice(":", 0)] = value == "true"
+		elif value.is_valid_int():
+			parsed[pair.get_slice(":", 0)] = value.to_int()
+		elif value.is_valid_float():
+			parsed[pair.get_slice(":", 0)] = value.to_float()
+		else:
+			parsed[pair.get_slice(":", 0)] = value
+	return parsed
+
+# Median of every metric over all runs of one import, which is called with
+# its scene directory and import options and returns the import report
+func benchmark(name: String, run_import: Callable) -> Dictionary:
+	var scene_dir = OUTPUT_ROOT + "/" + name.validate_filename()
+	var options = import_options.duplicate()
+	options.merge({
+		"thread_count": thread_count,
+		"use_cache": false,
+		"log_level": "error",
+	}, true)
+	var samples := {}
+	for run in runs:
+		var report: Dictionary = run_import.call(scene_dir, options)
+		add_sample(samples, "total_wall_usec", report.total.wall_usec)
+		add_sample(samples, "total_cpu_usec", report.total.cpu_usec)
+		for phase in report.phases:
+			add_sample(samples, "phase." + phase + ".wall_usec", report.phases[phase].wall_usec)
+		add_sample(samples, "bytes_written", report.counts.get("bytes_written", 0))
+		for count in STRUCTURE_COUNTS:
+			add_sample(samples, "count." + count, report.counts.get(count, 0))
+		print(name, " run ", run + 1, "/", runs, ": ", report.total.wall_usec / 1000.0, " ms")
+	var result := {}
+	for metric in samples:
+		result[metric] = median(samples[metric])
+	result["peak_rss_kb"] = peak_rss_kb()
+	return result
+
+func add_sample(samples: Dictionary, metric: String, value) -> void:
+	if not samples.has(metric):
+		samples[metric] = []
+	samples[metric].push_back(value)
+
+func median(values: Array):
+	values.sort()
+	return values[values.size() / 2]
+
+func peak_rss_kb() -> int:
+	var status = FileAccess.get_file_as_string("/proc/self/status")
+	for line in status.split("\n"):
+		if line.begins_with("VmHWM:"):
+			return line.get_slice(":", 1).strip_edges().get_slice(" ", 0).to_int()
+	return OS.get_static_memory_peak_usage() / 1024
+
+# Every metric more than tolerance worse than its baseline. Output size is
+# deterministic so any growth at all is reported, and structure counts must
+# match exactly.
+func compare(baseline: Dictionary, results: Dictionary) -> Array:
+	var regressions := []
+	for name in baseline:
+		if not results.has(name):
+			continue
+		var expected: Dictionary = baseline[name]
+		var actual: Dictionary = results[name]
+		for metric in expected:
+			if not actual.has(metric):
+				continue
+			if metric.begins_with("count."):
+				if actual[metric] != expected[metric]:
+					regressions.push_back("%s %s: %d, expected %d" % [name, metric, actual[metric], expected[metric]])
+				continue
+			var limit = expected[metric] * (1.0 + tolerance)
+			if metric == "bytes_written":
+				limit = expected[metric]
+			elif metric.ends_with("_usec") and expected[metric] < min_usec:
+				continue
+			if actual[metric] > limit:
+				regressions.push_back("%s %s: %d, baseline %d" % [name, metric, actual[metric], expected[metric]])
+	return regressions
+
+func save_json(path: String, data) -> void:
+	var file = FileAccess.open(path, FileAccess.WRITE)
+	if file == null:
+		printerr("Could not write ", path)
+		return
+	file.store_string(JSON.stringify(data, "\t"))
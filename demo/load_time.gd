@@ -0,0 +1,34 @@
+@tool
+
+extends EditorScript
+
+# Imports one level in every output format and prints how long Godot takes
+# to load each resulting scene. The level is passed to the editor after
+# "--", e.g.
+#
+#   godot --editor --path demo -- --lvl=/path/to/geo1.lvl
+
+const FORMATS = ["text", "binary", "binary_compressed"]
+
+func _run():
+	var lvl_path := ""
+	for arg in OS.get_cmdline_user_args():
+		if arg.begins_with("--lvl="):
+			lvl_path = arg.substr(arg.find("=") + 1)
+	if lvl_path == "":
+		printerr("No level to import; start the editor with -- --lvl=PATH")
+		return
+
+	var lvl_name = lvl_path.get_file()
+	for format in FORMATS:
+		var scene_dir = "res://" + lvl_name.get_basename() + "_" + format
+		LVLImport.import_lvl(lvl_path, scene_dir, { "output_format": format, "use_cache": false })
+		var extension = ".tscn" if format == "text" else ".scn"
+		var scene_path = scene_dir + "/" + lvl_name + extension
+		var start = Time.get_ticks_usec()
+		var scene = ResourceLoader.load(scene_path, "", ResourceLoader.CACHE_MODE_IGNORE_DEEP)
+		var elapsed = (Time.get_ticks_usec() - start) / 1000.0
+		if scene == null:
+			printerr("Failed to load ", scene_path)
+			continue
+		print(format, ": loaded ", scene_path, " in ", elapsed, " ms")
@@ -3,4 +3,22 @@
 extends EditorScript
 
 func _run():
-	LVLImport.import_lvl("/home/rain/.local/share/Steam/steamapps/common/Star Wars Battlefront II Classic/GameData/data/_lvl_pc/geo/geo1.lvl", "res://geo1")
+	# Import in the background so the editor stays responsive. The importer
+	# has to be in the tree to run its resource saves on the main thread.
+	var importer := LVLImport.new()
+	# Keeps this script, and so the callbacks below, alive until it finishes
+	importer.set_meta("editor_script", self)
+	importer.progress.connect(_on_progress)
+	importer.finished.connect(_on_finished.bind(importer))
+	EditorInterface.get_base_control().add_child(importer)
+	importer.import_lvl_async("/home/rain/.local/share/Steam/steamapps/common/Star Wars Battlefront II Classic/GameData/data/_lvl_pc/geo/geo1.lvl", "res://geo1")
+
+func _on_progress(phase: String, done: int, total: int):
+	print("%s %d/%d" % [phase, done, total])
+
+func _on_finished(report: Dictionary, importer: LVLImport):
+	if report.get("cancelled", false):
+		print("Import cancelled")
+	else:
+		print("Import finished in %.1f s" % (report.total.wall_usec / 1e6))
+	importer.queue_free()
@@ -0,0 +1,19 @@
+extends SceneTree
+
+# Runs the library's C++ tests and exits non-zero if any failed. They are
+# only compiled in by building with
+#
+#   scons test godot=/path/to/godot
+
+func _initialize():
+	if not ClassDB.class_exists("LVLImportTests"):
+		printerr("The library was built without tests; build it with scons test")
+		quit(2)
+		return
+	var failures: int = ClassDB.instantiate("LVLImportTests").run()
+	if failures == 0:
+		print("All tests passed")
+		quit(0)
+	else:
+		printerr(failures, " checks failed")
+		quit(1)
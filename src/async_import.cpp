@@ -0,0 +1,82 @@
+#include "async_import.hpp"
+#include "import_report.hpp"
+#include <chrono>
+
+namespace godot {
+
+void AsyncImport::call_on_main_thread(const std::function<void()> &fn) {
+	Call call;
+	call.fn = &fn;
+	std::unique_lock<std::mutex> lock(mutex);
+	if (closed) {
+		lock.unlock();
+		fn();
+		return;
+	}
+	calls.push_back(&call);
+	queued_cv.notify_one();
+	done_cv.wait(lock, [&] { return call.done; });
+}
+
+void AsyncImport::run_main_thread_calls(uint64_t budget_usec) {
+	const uint64_t start_usec = ImportReport::wall_usec();
+	std::unique_lock<std::mutex> lock(mutex);
+	if (calls.empty()) {
+		return;
+	}
+	while (true) {
+		if (calls.empty()) {
+			uint64_t elapsed_usec = ImportReport::wall_usec() - start_usec;
+			if (elapsed_usec >= budget_usec ||
+			    !queued_cv.wait_for(lock, std::chrono::microseconds(budget_usec - elapsed_usec), [&] { return !calls.empty(); })) {
+				return;
+			}
+		}
+		Call *call = calls.front();
+		calls.pop_front();
+		lock.unlock();
+		(*call->fn)();
+		lock.lock();
+		call->done = true;
+		done_cv.notify_all();
+		if (ImportReport::wall_usec() - start_usec >= budget_usec) {
+			return;
+		}
+	}
+}
+
+void AsyncImport::close() {
+	std::unique_lock<std::mutex> lock(mutex);
+	closed = true;
+	while (!calls.empty()) {
+		Call *call = calls.front();
+		calls.pop_front();
+		lock.unlock();
+		(*call->fn)();
+		lock.lock();
+		call->done = true;
+	}
+	done_cv.notify_all();
+}
+
+void AsyncImport::set_progress(const String &phase, int64_t done, int64_t total) {
+	std::lock_guard<std::mutex> lock(mutex);
+	progress_phase = phase;
+	progress_done = done;
+	progress_total = total;
+	progress_changed = true;
+}
+
+bool AsyncImport::take_progress(String &phase, int64_t &done, int64_t &total) {
+	std::lock_guard<std::mutex> lock(mutex);
+	if (!progress_changed) {
+		return false;
+	}
+	phase = progress_phase;
+	done = progress_done;
+	total = progress_total;
+	progress_changed = false;
+	return true;
+}
+
+}
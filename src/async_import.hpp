@@ -0,0 +1,69 @@
+#ifndef LVLIMPORT_ASYNC_IMPORT_HPP_
+#define LVLIMPORT_ASYNC_IMPORT_HPP_
+
+#include <godot_cpp/variant/dictionary.hpp>
+#include <godot_cpp/variant/string.hpp>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+
+namespace godot {
+
+// Time the main thread spends on an import's calls each frame before
+// returning to the editor
+constexpr uint64_t MAIN_THREAD_BUDGET_USEC = 8000;
+
+// State shared between an import running on a background thread and the
+// LVLImport node driving it from the main thread. The import thread
+// queues calls that must run on the main thread, such as saving and
+// loading resources, and publishes its progress. The main thread runs the
+// queued calls in batches and polls progress from _process.
+class AsyncImport {
+	struct Call {
+		const std::function<void()> *fn;
+		bool done = false;
+	};
+
+	std::mutex mutex;
+	std::condition_variable queued_cv;
+	std::condition_variable done_cv;
+	std::deque<Call *> calls;
+	bool closed = false;
+
+	String progress_phase;
+	int64_t progress_done = 0;
+	int64_t progress_total = 0;
+	bool progress_changed = false;
+
+public:
+	std::atomic_bool cancel_requested = false;
+	std::atomic_bool finished = false;
+	Dictionary report; // Written by the import thread before finished is set
+
+	// Import thread: runs fn on the main thread and waits for it. Runs fn
+	// directly once the queue is closed.
+	void call_on_main_thread(const std::function<void()> &fn);
+
+	// Main thread: runs queued calls. While calls keep arriving it waits for
+	// the next one, returning once budget_usec has passed or none arrives
+	// within it, so bursts of saves finish in few frames.
+	void run_main_thread_calls(uint64_t budget_usec);
+
+	// Runs every queued call and every later one on the calling thread, for
+	// when the main thread stops polling before the import has finished
+	void close();
+
+	// Import thread: only the latest progress is kept, so a slow main
+	// thread never falls behind
+	void set_progress(const String &phase, int64_t done, int64_t total);
+
+	// Main thread: fills the latest progress if it changed since last taken
+	bool take_progress(String &phase, int64_t &done, int64_t &total);
+};
+
+}
+
+#endif
@@ -0,0 +1,633 @@
+#include "convex_decompose.hpp"
+#include "worker_pool.hpp"
+#include <godot_cpp/core/defs.hpp>
+#include <algorithm>
+#include <cmath>
+#include <unordered_map>
+
+namespace godot {
+
+namespace {
+
+struct DVec {
+	double x = 0, y = 0, z = 0;
+
+	DVec() {}
+	DVec(double x, double y, double z) : x(x), y(y), z(z) {}
+	explicit DVec(const Vector3 &v) : x(v.x), y(v.y), z(v.z) {}
+
+	DVec operator+(const DVec &o) const { return DVec(x + o.x, y + o.y, z + o.z); }
+	DVec operator-(const DVec &o) const { return DVec(x - o.x, y - o.y, z - o.z); }
+	DVec operator*(double s) const { return DVec(x * s, y * s, z * s); }
+	double operator[](int axis) const { return axis == 0 ? x : (axis == 1 ? y : z); }
+	double &operator[](int axis) { return axis == 0 ? x : (axis == 1 ? y : z); }
+};
+
+double dot(const DVec &a, const DVec &b) {
+	return a.x * b.x + a.y * b.y + a.z * b.z;
+}
+
+DVec cross(const DVec &a, const DVec &b) {
+	return DVec(a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x);
+}
+
+struct HullFace {
+	uint32_t v[3];
+	DVec normal;
+	double offset = 0;
+	std::vector<uint32_t> outside;
+	bool alive = true;
+};
+
+uint64_t edge_key(uint32_t a, uint32_t b) {
+	return (static_cast<uint64_t>(a) << 32) | b;
+}
+
+}
+
+bool compute_convex_hull(const Vector3 *points, uint32_t count, ConvexHull &out, uint32_t max_vertices) {
+	out = ConvexHull();
+	if (count < 4) {
+		return false;
+	}
+	std::vector<DVec> p(count);
+	DVec lo(points[0]), hi(points[0]);
+	for (uint32_t i = 0; i < count; ++ i) {
+		p[i] = DVec(points[i]);
+		for (int a = 0; a < 3; ++ a) {
+			lo[a] = MIN(lo[a], p[i][a]);
+			hi[a] = MAX(hi[a], p[i][a]);
+		}
+	}
+	const DVec extent = hi - lo;
+	const double scale = MAX(extent.x, MAX(extent.y, extent.z));
+	const double eps = scale * 1e-7;
+	if (!(scale > 0.0)) {
+		return false;
+	}
+
+	// Initial tetrahedron: the extremes along the widest axis, the point
+	// furthest from their line, then the point furthest from their plane
+	int axis = extent.x >= extent.y ? (extent.x >= extent.z ? 0 : 2) : (extent.y >= extent.z ? 1 : 2);
+	uint32_t i0 = 0, i1 = 0;
+	for (uint32_t i = 1; i < count; ++ i) {
+		if (p[i][axis] < p[i0][axis]) {
+			i0 = i;
+		}
+		if (p[i][axis] > p[i1][axis]) {
+			i1 = i;
+		}
+	}
+	const DVec line = p[i1] - p[i0];
+	uint32_t i2 = i0;
+	double best = 0;
+	for (uint32_t i = 0; i < count; ++ i) {
+		double d = dot(cross(line, p[i] - p[i0]), cross(line, p[i] - p[i0]));
+		if (d > best) {
+			best = d;
+			i2 = i;
+		}
+	}
+	if (std::sqrt(best) <= eps * std::sqrt(dot(line, line))) {
+		return false;
+	}
+	DVec plane_normal = cross(line, p[i2] - p[i0]);
+	plane_normal = plane_normal * (1.0 / std::sqrt(dot(plane_normal, plane_normal)));
+	uint32_t i3 = i0;
+	best = 0;
+	for (uint32_t i = 0; i < count; ++ i) {
+		double d = std::abs(dot(plane_normal, p[i] - p[i0]));
+		if (d > best) {
+			best = d;
+			i3 = i;
+		}
+	}
+	if (best <= eps) {
+		return false;
+	}
+
+	std::vector<HullFace> faces;
+	std::unordered_map<uint64_t, uint32_t> edge_face;
+	auto add_face = [&](uint32_t a, uint32_t b, uint32_t c) {
+		HullFace face;
+		face.v[0] = a;
+		face.v[1] = b;
+		face.v[2] = c;
+		face.normal = cross(p[b] - p[a], p[c] - p[a]);
+		double length = std::sqrt(dot(face.normal, face.normal));
+		face.normal = length > 0.0 ? face.normal * (1.0 / length) : DVec();
+		face.offset = dot(face.normal, p[a]);
+		uint32_t f = faces.size();
+		for (int e = 0; e < 3; ++ e) {
+			edge_face[edge_key(face.v[e], face.v[(e + 1) % 3])] = f;
+		}
+		faces.push_back(std::move(face));
+		return f;
+	};
+	auto distance = [&](const HullFace &face, uint32_t i) {
+		return dot(face.normal, p[i]) - face.offset;
+	};
+
+	// Wind the tetrahedron's faces away from the vertex opposite each
+	if (dot(plane_normal, p[i3] - p[i0]) > 0.0) {
+		std::swap(i1, i2);
+	}
+	add_face(i0, i1, i2);
+	add_face(i0, i3, i1);
+	add_face(i1, i3, i2);
+	add_face(i2, i3, i0);
+
+	for (uint32_t i = 0; i < count; ++ i) {
+		if (i == i0 || i == i1 || i == i2 || i == i3) {
+			continue;
+		}
+		for (HullFace &face : faces) {
+			if (distance(face, i) > eps) {
+				face.outside.push_back(i);
+				break;
+			}
+		}
+	}
+
+	std::vector<uint32_t> visible;
+	std::vector<uint32_t> horizon; // Pairs of vertices
+	std::vector<uint32_t> orphans;
+	uint32_t hull_vertices = 4;
+	for (uint32_t f = 0; f < faces.size(); ++ f) {
+		if (max_vertices >= 4 && hull_vertices >= max_vertices) {
+			break;
+		}
+		if (!faces[f].alive || faces[f].outside.empty()) {
+			continue;
+		}
+		hull_vertices += 1;
+		uint32_t apex = faces[f].outside[0];
+		double apex_distance = distance(faces[f], apex);
+		for (uint32_t i : faces[f].outside) {
+			double d = distance(faces[f], i);
+			if (d > apex_distance) {
+				apex = i;
+				apex_distance = d;
+			}
+		}
+
+		// Flood out from f over every face the apex sees. The edges where it
+		// stops form the horizon the new faces are fanned from.
+		visible.clear();
+		horizon.clear();
+		visible.push_back(f);
+		faces[f].alive = false;
+		for (size_t vi = 0; vi < visible.size(); ++ vi) {
+			const HullFace &face = faces[visible[vi]];
+			for (int e = 0; e < 3; ++ e) {
+				uint32_t a = face.v[e];
+				uint32_t b = face.v[(e + 1) % 3];
+				auto twin_it = edge_face.find(edge_key(b, a));
+				if (twin_it == edge_face.end()) {
+					continue;
+				}
+				uint32_t twin = twin_it->second;
+				if (!faces[twin].alive) {
+					continue; // Already visible
+				}
+				if (distance(faces[twin], apex) > eps) {
+					faces[twin].alive = false;
+					visible.push_back(twin);
+				} else {
+					horizon.push_back(a);
+					horizon.push_back(b);
+				}
+			}
+		}
+		orphans.clear();
+		for (uint32_t v : visible) {
+			for (uint32_t i : faces[v].outside) {
+				if (i != apex) {
+					orphans.push_back(i);
+				}
+			}
+			std::vector<uint32_t>().swap(faces[v].outside);
+			for (int e = 0; e < 3; ++ e) {
+				uint64_t key = edge_key(faces[v].v[e], faces[v].v[(e + 1) % 3]);
+				auto it = edge_face.find(key);
+				if (it != edge_face.end() && it->second == v) {
+					edge_face.erase(it);
+				}
+			}
+		}
+
+		const uint32_t first_new = faces.size();
+		for (size_t h = 0; h < horizon.size(); h += 2) {
+			add_face(horizon[h], horizon[h + 1], apex);
+		}
+		for (uint32_t i : orphans) {
+			for (uint32_t nf = first_new; nf < faces.size(); ++ nf) {
+				if (distance(faces[nf], i) > eps) {
+					faces[nf].outside.push_back(i);
+					break;
+				}
+			}
+		}
+	}
+
+	std::vector<uint32_t> remap(count, UINT32_MAX);
+	DVec center = (lo + hi) * 0.5;
+	for (const HullFace &face : faces) {
+		if (!face.alive) {
+			continue;
+		}
+		for (int e = 0; e < 3; ++ e) {
+			if (remap[face.v[e]] == UINT32_MAX) {
+				remap[face.v[e]] = out.vertex.size();
+				out.vertex.push_back(points[face.v[e]]);
+			}
+		}
+		out.volume += dot(p[face.v[0]] - center, cross(p[face.v[1]] - center, p[face.v[2]] - center)) / 6.0;
+	}
+	return true;
+}
+
+namespace {
+
+// Akenine-Möller's separating axis test
+bool triangle_overlaps_box(const DVec &center, double half, DVec v0, DVec v1, DVec v2) {
+	v0 = v0 - center;
+	v1 = v1 - center;
+	v2 = v2 - center;
+	const DVec edges[3] = { v1 - v0, v2 - v1, v0 - v2 };
+	for (const DVec &edge : edges) {
+		for (int axis = 0; axis < 3; ++ axis) {
+			DVec unit;
+			unit[axis] = 1.0;
+			DVec a = cross(unit, edge);
+			double p0 = dot(a, v0), p1 = dot(a, v1), p2 = dot(a, v2);
+			double r = half * (std::abs(a.x) + std::abs(a.y) + std::abs(a.z));
+			if (MIN(p0, MIN(p1, p2)) > r || MAX(p0, MAX(p1, p2)) < -r) {
+				return false;
+			}
+		}
+	}
+	for (int axis = 0; axis < 3; ++ axis) {
+		if (MIN(v0[axis], MIN(v1[axis], v2[axis])) > half || MAX(v0[axis], MAX(v1[axis], v2[axis])) < -half) {
+			return false;
+		}
+	}
+	DVec normal = cross(edges[0], edges[1]);
+	double r = half * (std::abs(normal.x) + std::abs(normal.y) + std::abs(normal.z));
+	return std::abs(dot(normal, v0)) <= r;
+}
+
+// Solid voxels of a mesh, padded by a voxel of empty space on every side.
+// Voxels the surface crosses count as half full, the rest as full.
+struct Voxels {
+	DVec origin;
+	double size = 1;
+	uint32_t dim[3] = {};
+	std::vector<uint8_t> fill; // Halves of each voxel that are solid
+	std::vector<uint32_t> prefix; // Solid halves below and before each corner
+
+	size_t index(uint32_t x, uint32_t y, uint32_t z) const {
+		return (static_cast<size_t>(z) * dim[1] + y) * dim[0] + x;
+	}
+
+	size_t prefix_index(uint32_t x, uint32_t y, uint32_t z) const {
+		return (static_cast<size_t>(z) * (dim[1] + 1) + y) * (dim[0] + 1) + x;
+	}
+
+	// Solid halves within the box
+	uint32_t count(const uint32_t lo[3], const uint32_t hi[3]) const {
+		auto at = [&](uint32_t x, uint32_t y, uint32_t z) {
+			return static_cast<int64_t>(prefix[prefix_index(x, y, z)]);
+		};
+		return static_cast<uint32_t>(at(hi[0], hi[1], hi[2])
+			- at(lo[0], hi[1], hi[2]) - at(hi[0], lo[1], hi[2]) - at(hi[0], hi[1], lo[2])
+			+ at(lo[0], lo[1], hi[2]) + at(lo[0], hi[1], lo[2]) + at(hi[0], lo[1], lo[2])
+			- at(lo[0], lo[1], lo[2]));
+	}
+};
+
+void voxelize(const std::vector<DVec> &tri, const DVec &lo, const DVec &hi, uint32_t resolution, Voxels &out) {
+	const DVec extent = hi - lo;
+	const double longest = MAX(extent.x, MAX(extent.y, extent.z));
+	out.size = longest / MAX(resolution, 1u);
+	// The bounds lie on voxel centres, so the faces of boxy meshes cross
+	// the middle of voxels rather than lining up with their sides
+	for (int a = 0; a < 3; ++ a) {
+		out.dim[a] = static_cast<uint32_t>(std::ceil(extent[a] / out.size + 1.0)) + 2;
+	}
+	out.origin = lo - DVec(out.size, out.size, out.size) * 1.5;
+
+	enum : uint8_t { UNKNOWN, SURFACE, OUTSIDE };
+	std::vector<uint8_t> state(static_cast<size_t>(out.dim[0]) * out.dim[1] * out.dim[2], UNKNOWN);
+	// Slightly enlarged so triangles on voxel sides can't slip between them
+	const double half = out.size * 0.5 * (1.0 + 1e-4);
+	for (size_t t = 0; t < tri.size(); t += 3) {
+		uint32_t vlo[3], vhi[3];
+		for (int a = 0; a < 3; ++ a) {
+			double tmin = MIN(tri[t][a], MIN(tri[t + 1][a], tri[t + 2][a]));
+			double tmax = MAX(tri[t][a], MAX(tri[t + 1][a], tri[t + 2][a]));
+			vlo[a] = static_cast<uint32_t>(CLAMP(std::floor((tmin - out.origin[a]) / out.size - 1e-4), 0.0, double(out.dim[a] - 1)));
+			vhi[a] = static_cast<uint32_t>(CLAMP(std::floor((tmax - out.origin[a]) / out.size + 1e-4), 0.0, double(out.dim[a] - 1)));
+		}
+		for (uint32_t z = vlo[2]; z <= vhi[2]; ++ z) {
+			for (uint32_t y = vlo[1]; y <= vhi[1]; ++ y) {
+				for (uint32_t x = vlo[0]; x <= vhi[0]; ++ x) {
+					uint8_t &s = state[out.index(x, y, z)];
+					if (s == SURFACE) {
+						continue;
+					}
+					DVec center = out.origin + DVec(x + 0.5, y + 0.5, z + 0.5) * out.size;
+					if (triangle_overlaps_box(center, half, tri[t], tri[t + 1], tri[t + 2])) {
+						s = SURFACE;
+					}
+				}
+			}
+		}
+	}
+
+	// Flood the outside from the padding. Whatever it can't reach is inside.
+	std::vector<uint32_t> stack;
+	stack.push_back(0);
+	state[0] = OUTSIDE;
+	while (!stack.empty()) {
+		uint32_t i = stack.back();
+		stack.pop_back();
+		uint32_t x = i % out.dim[0];
+		uint32_t y = (i / out.dim[0]) % out.dim[1];
+		uint32_t z = i / (out.dim[0] * out.dim[1]);
+		auto visit = [&](uint32_t nx, uint32_t ny, uint32_t nz) {
+			size_t n = out.index(nx, ny, nz);
+			if (state[n] == UNKNOWN) {
+				state[n] = OUTSIDE;
+				stack.push_back(static_cast<uint32_t>(n));
+			}
+		};
+		if (x > 0) visit(x - 1, y, z);
+		if (y > 0) visit(x, y - 1, z);
+		if (z > 0) visit(x, y, z - 1);
+		if (x + 1 < out.dim[0]) visit(x + 1, y, z);
+		if (y + 1 < out.dim[1]) visit(x, y + 1, z);
+		if (z + 1 < out.dim[2]) visit(x, y, z + 1);
+	}
+
+	out.fill.resize(state.size());
+	for (size_t i = 0; i < state.size(); ++ i) {
+		out.fill[i] = state[i] == OUTSIDE ? 0 : (state[i] == SURFACE ? 1 : 2);
+	}
+	out.prefix.assign(static_cast<size_t>(out.dim[0] + 1) * (out.dim[1] + 1) * (out.dim[2] + 1), 0);
+	for (uint32_t z = 0; z < out.dim[2]; ++ z) {
+		for (uint32_t y = 0; y < out.dim[1]; ++ y) {
+			for (uint32_t x = 0; x < out.dim[0]; ++ x) {
+				out.prefix[out.prefix_index(x + 1, y + 1, z + 1)] = out.fill[out.index(x, y, z)]
+					+ out.prefix[out.prefix_index(x, y + 1, z + 1)]
+					+ out.prefix[out.prefix_index(x + 1, y, z + 1)]
+					+ out.prefix[out.prefix_index(x + 1, y + 1, z)]
+					- out.prefix[out.prefix_index(x, y, z + 1)]
+					- out.prefix[out.prefix_index(x, y + 1, z)]
+					- out.prefix[out.prefix_index(x + 1, y, z)]
+					+ out.prefix[out.prefix_index(x, y, z)];
+			}
+		}
+	}
+}
+
+// A box of voxels and the hull of the mesh within it
+struct Part {
+	uint32_t lo[3] = {};
+	uint32_t hi[3] = {};
+	std::vector<uint32_t> triangles;
+	std::vector<Vector3> hull;
+	double solid_volume = 0;
+	double concavity = 0;
+	bool splittable = true;
+};
+
+// Clips a triangle to a box with Sutherland-Hodgman, appending the
+// remaining polygon's vertices to points
+void clip_triangle(const DVec *tri, const DVec &lo, const DVec &hi, double eps, std::vector<Vector3> &points) {
+	DVec buffer[2][9];
+	uint32_t size = 3;
+	DVec *in = buffer[0];
+	DVec *out = buffer[1];
+	in[0] = tri[0];
+	in[1] = tri[1];
+	in[2] = tri[2];
+	for (int plane = 0; plane < 6 && size > 0; ++ plane) {
+		const int axis = plane / 2;
+		const bool upper = plane % 2;
+		const double bound = upper ? hi[axis] + eps : lo[axis] - eps;
+		auto inside = [&](const DVec &v) {
+			return upper ? v[axis] <= bound : v[axis] >= bound;
+		};
+		uint32_t out_size = 0;
+		for (uint32_t i = 0; i < size; ++ i) {
+			const DVec &a = in[i];
+			const DVec &b = in[(i + 1) % size];
+			bool a_in = inside(a);
+			bool b_in = inside(b);
+			if (a_in) {
+				out[out_size++] = a;
+			}
+			if (a_in != b_in) {
+				double t = (bound - a[axis]) / (b[axis] - a[axis]);
+				out[out_size++] = a + (b - a) * t;
+			}
+		}
+		size = out_size;
+		std::swap(in, out);
+	}
+	for (uint32_t i = 0; i < size; ++ i) {
+		points.push_back(Vector3(in[i].x, in[i].y, in[i].z));
+	}
+}
+
+// Shrinks the box to its solid voxels, keeps the parent's triangles which
+// may cross it and builds its hull. Returns false if the box is empty.
+bool build_part(const Voxels &voxels, const std::vector<DVec> &tri, const std::vector<DVec> &tri_lo, const std::vector<DVec> &tri_hi,
+                const std::vector<uint32_t> &parent_triangles, const uint32_t lo[3], const uint32_t hi[3], Part &out) {
+	uint32_t solid_halves = voxels.count(lo, hi);
+	if (solid_halves == 0) {
+		return false;
+	}
+	for (int a = 0; a < 3; ++ a) {
+		out.lo[a] = lo[a];
+		out.hi[a] = hi[a];
+	}
+	for (int a = 0; a < 3; ++ a) {
+		uint32_t slab_lo[3] = { out.lo[0], out.lo[1], out.lo[2] };
+		uint32_t slab_hi[3] = { out.hi[0], out.hi[1], out.hi[2] };
+		while (true) {
+			slab_lo[a] = out.lo[a];
+			slab_hi[a] = out.lo[a] + 1;
+			if (voxels.count(slab_lo, slab_hi) > 0) {
+				break;
+			}
+			out.lo[a] += 1;
+		}
+		while (true) {
+			slab_lo[a] = out.hi[a] - 1;
+			slab_hi[a] = out.hi[a];
+			if (voxels.count(slab_lo, slab_hi) > 0) {
+				break;
+			}
+			out.hi[a] -= 1;
+		}
+	}
+	out.solid_volume = solid_halves * 0.5 * voxels.size * voxels.size * voxels.size;
+
+	const DVec box_lo = voxels.origin + DVec(out.lo[0], out.lo[1], out.lo[2]) * voxels.size;
+	const DVec box_hi = voxels.origin + DVec(out.hi[0], out.hi[1], out.hi[2]) * voxels.size;
+	const double eps = voxels.size * 1e-4;
+	std::vector<Vector3> points;
+	out.triangles.clear();
+	for (uint32_t t : parent_triangles) {
+		if (tri_lo[t].x > box_hi.x + eps || tri_lo[t].y > box_hi.y + eps || tri_lo[t].z > box_hi.z + eps ||
+		    tri_hi[t].x < box_lo.x - eps || tri_hi[t].y < box_lo.y - eps || tri_hi[t].z < box_lo.z - eps) {
+			continue;
+		}
+		out.triangles.push_back(t);
+		clip_triangle(&tri[t * 3], box_lo, box_hi, eps, points);
+	}
+
+	ConvexHull hull;
+	if (compute_convex_hull(points.data(), points.size(), hull)) {
+		out.concavity = MAX(hull.volume - out.solid_volume, 0.0);
+	} else {
+		// The mesh within the box is flat, as a lone wall is, or missing,
+		// as it is for a box cut from the inside of a solid. Its voxels
+		// fill the box, which is then the best hull we have and can't be
+		// improved by cutting.
+		points.clear();
+		for (int corner = 0; corner < 8; ++ corner) {
+			points.push_back(Vector3(corner & 1 ? box_hi.x : box_lo.x, corner & 2 ? box_hi.y : box_lo.y, corner & 4 ? box_hi.z : box_lo.z));
+		}
+		compute_convex_hull(points.data(), points.size(), hull);
+		out.concavity = 0.0;
+	}
+	out.hull = std::move(hull.vertex);
+	return true;
+}
+
+}
+
+void decompose_convex(const Vector3 *faces, uint32_t face_vertex_count, const ConvexDecompositionParams &params,
+                      WorkerPool &pool, ConvexDecomposition &out) {
+	out = ConvexDecomposition();
+	const uint32_t triangle_count = face_vertex_count / 3;
+	if (triangle_count == 0) {
+		return;
+	}
+
+	std::vector<DVec> tri(triangle_count * 3);
+	std::vector<DVec> tri_lo(triangle_count);
+	std::vector<DVec> tri_hi(triangle_count);
+	DVec lo(faces[0]), hi(faces[0]);
+	for (uint32_t t = 0; t < triangle_count; ++ t) {
+		for (int c = 0; c < 3; ++ c) {
+			tri[t * 3 + c] = DVec(faces[t * 3 + c]);
+		}
+		for (int a = 0; a < 3; ++ a) {
+			tri_lo[t][a] = MIN(tri[t * 3][a], MIN(tri[t * 3 + 1][a], tri[t * 3 + 2][a]));
+			tri_hi[t][a] = MAX(tri[t * 3][a], MAX(tri[t * 3 + 1][a], tri[t * 3 + 2][a]));
+			lo[a] = MIN(lo[a], tri_lo[t][a]);
+			hi[a] = MAX(hi[a], tri_hi[t][a]);
+		}
+	}
+	const DVec extent = hi - lo;
+	if (!(MAX(extent.x, MAX(extent.y, extent.z)) > 0.0)) {
+		return;
+	}
+
+	Voxels voxels;
+	voxelize(tri, lo, hi, params.resolution, voxels);
+
+	std::vector<uint32_t> all_triangles(triangle_count);
+	for (uint32_t t = 0; t < triangle_count; ++ t) {
+		all_triangles[t] = t;
+	}
+	std::vector<Part> parts(1);
+	const uint32_t grid_lo[3] = { 0, 0, 0 };
+	if (!build_part(voxels, tri, tri_lo, tri_hi, all_triangles, grid_lo, voxels.dim, parts[0])) {
+		return;
+	}
+	const double total_volume = parts[0].solid_volume;
+	const uint32_t max_hulls = MAX(params.max_hulls, 1u);
+
+	struct Cut {
+		int axis;
+		uint32_t plane;
+		bool valid = false;
+		Part below;
+		Part above;
+	};
+	std::vector<Cut> cuts;
+	while (parts.size() < max_hulls) {
+		// Cut the part that leaves the most volume outside the mesh
+		uint32_t worst = UINT32_MAX;
+		double concavity = 0;
+		for (uint32_t i = 0; i < parts.size(); ++ i) {
+			concavity += parts[i].concavity;
+			if (parts[i].splittable && (worst == UINT32_MAX || parts[i].concavity > parts[worst].concavity)) {
+				worst = i;
+			}
+		}
+		if (worst == UINT32_MAX || concavity <= params.max_error * total_volume) {
+			break;
+		}
+		const Part &part = parts[worst];
+
+		// Up to 7 evenly spaced voxel planes across each axis
+		cuts.clear();
+		for (int axis = 0; axis < 3; ++ axis) {
+			const uint32_t span = part.hi[axis] - part.lo[axis];
+			const uint32_t planes = MIN(span - 1, 7u);
+			for (uint32_t i = 1; i <= planes; ++ i) {
+				uint32_t plane = part.lo[axis] + span * i / (planes + 1);
+				if (cuts.empty() || cuts.back().axis != axis || cuts.back().plane != plane) {
+					cuts.push_back(Cut());
+					cuts.back().axis = axis;
+					cuts.back().plane = plane;
+				}
+			}
+		}
+		pool.run(cuts.size(), [&](uint32_t c) {
+			Cut &cut = cuts[c];
+			uint32_t below_hi[3] = { part.hi[0], part.hi[1], part.hi[2] };
+			uint32_t above_lo[3] = { part.lo[0], part.lo[1], part.lo[2] };
+			below_hi[cut.axis] = cut.plane;
+			above_lo[cut.axis] = cut.plane;
+			cut.valid = build_part(voxels, tri, tri_lo, tri_hi, part.triangles, part.lo, below_hi, cut.below) &&
+			            build_part(voxels, tri, tri_lo, tri_hi, part.triangles, above_lo, part.hi, cut.above);
+		});
+
+		uint32_t best = UINT32_MAX;
+		for (uint32_t c = 0; c < cuts.size(); ++ c) {
+			if (cuts[c].valid && (best == UINT32_MAX ||
+			    cuts[c].below.concavity + cuts[c].above.concavity < cuts[best].below.concavity + cuts[best].above.concavity)) {
+				best = c;
+			}
+		}
+		if (best == UINT32_MAX) {
+			parts[worst].splittable = false;
+			continue;
+		}
+		parts[worst] = std::move(cuts[best].below);
+		parts.push_back(std::move(cuts[best].above));
+	}
+
+	double concavity = 0;
+	for (const Part &part : parts) {
+		concavity += part.concavity;
+		ConvexHull simplified;
+		const std::vector<Vector3> &vertex = compute_convex_hull(part.hull.data(), part.hull.size(), simplified, params.max_hull_vertices) ? simplified.vertex : part.hull;
+		PackedVector3Array hull;
+		hull.resize(vertex.size());
+		for (size_t i = 0; i < vertex.size(); ++ i) {
+			hull[i] = vertex[i];
+		}
+		out.hulls.push_back(hull);
+	}
+	out.error = total_volume > 0.0 ? concavity / total_volume : 0.0;
+}
+
+}
@@ -0,0 +1,59 @@
+#ifndef LVLIMPORT_CONVEX_DECOMPOSE_HPP_
+#define LVLIMPORT_CONVEX_DECOMPOSE_HPP_
+
+#include <godot_cpp/variant/packed_vector3_array.hpp>
+#include <godot_cpp/variant/vector3.hpp>
+#include <cstdint>
+#include <vector>
+
+namespace godot {
+
+class WorkerPool;
+
+struct ConvexHull {
+	std::vector<Vector3> vertex;
+	double volume = 0;
+};
+
+// Quickhull. Returns false, leaving out empty, if the points span no volume.
+// Hull vertices are added furthest point first, so stopping after
+// max_vertices of them (zero for no limit) leaves the hull of the most
+// prominent points, slightly inside the full hull.
+bool compute_convex_hull(const Vector3 *points, uint32_t count, ConvexHull &out, uint32_t max_vertices = 0);
+
+struct ConvexDecompositionParams {
+	// Most hulls a mesh is split into
+	uint32_t max_hulls = 8;
+	// Stop splitting once the hulls' volume exceeds the mesh's by no more
+	// than this fraction of the mesh's volume
+	float max_error = 0.02f;
+	// Voxels along the mesh's longest axis
+	uint32_t resolution = 32;
+	// Most vertices in each hull returned, since collision cost grows with
+	// them. Cuts and the error are decided on the full hulls. Zero is
+	// unlimited.
+	uint32_t max_hull_vertices = 64;
+};
+
+struct ConvexDecomposition {
+	std::vector<PackedVector3Array> hulls;
+	// Volume the hulls cover beyond the mesh, as a fraction of the mesh's
+	// voxelized volume
+	float error = 0;
+};
+
+// Approximate convex decomposition in the manner of V-HACD. The triangle
+// soup in faces is voxelized and its interior filled, then the part with
+// the most volume outside the mesh is repeatedly cut in two along the axis
+// aligned plane that leaves the least, until the total error or the hull
+// budget is reached. Each part's hull is built from the triangles clipped
+// to its bounds, so hulls follow the mesh rather than its voxels. Meshes that
+// aren't closed decompose their surface's voxels. Candidate cuts are
+// evaluated across the pool, and the result is the same for any number of
+// threads.
+void decompose_convex(const Vector3 *faces, uint32_t face_vertex_count, const ConvexDecompositionParams &params,
+                      WorkerPool &pool, ConvexDecomposition &out);
+
+}
+
+#endif
@@ -0,0 +1,23 @@
+#ifndef LVLIMPORT_FNV_HPP_
+#define LVLIMPORT_FNV_HPP_
+
+#include <cstdint>
+
+namespace godot {
+
+// 32 bit FNV-1a of the lower cased bytes of str, matching LibSWBF2's
+// FNVHashString, so literal names can be hashed at compile time
+constexpr uint32_t fnv_hash(const char *str) {
+	uint32_t hash = 2166136261u;
+	for (; *str; ++ str) {
+		hash ^= static_cast<uint8_t>(*str) | 0x20;
+		hash *= 16777619u;
+	}
+	return hash;
+}
+
+static_assert(fnv_hash("GeometryName") == 1204317002u, "fnv_hash must match LibSWBF2's FNVHashString");
+
+}
+
+#endif
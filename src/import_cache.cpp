@@ -0,0 +1,118 @@
+#include "import_cache.hpp"
+#include <godot_cpp/classes/file_access.hpp>
+#include <godot_cpp/classes/json.hpp>
+#include <godot_cpp/variant/utility_functions.hpp>
+#include <cstring>
+
+namespace godot {
+
+// Bump whenever the importer's output changes for the same input, so
+// stale caches are rebuilt rather than trusted
+static constexpr int64_t CACHE_VERSION = 2;
+
+void ContentHasher::add_bytes(const void *data, size_t size) {
+	const uint8_t *bytes = static_cast<const uint8_t *>(data);
+	mix(size);
+	for (; size >= 8; size -= 8, bytes += 8) {
+		uint64_t word;
+		memcpy(&word, bytes, 8);
+		mix(word);
+	}
+	if (size > 0) {
+		uint64_t word = 0;
+		memcpy(&word, bytes, size);
+		mix(word);
+	}
+}
+
+void ContentHasher::add(const String &value) {
+	CharString utf8 = value.utf8();
+	add_bytes(utf8.get_data(), utf8.length());
+}
+
+void ImportCache::load(const String &scene_dir, const String &output_format) {
+	manifest_path = scene_dir + String("/lvlimport_cache.json");
+	this->output_format = output_format;
+	entries.clear();
+	if (!FileAccess::file_exists(manifest_path)) {
+		return;
+	}
+	Variant manifest = JSON::parse_string(FileAccess::get_file_as_string(manifest_path));
+	if (manifest.get_type() != Variant::DICTIONARY) {
+		UtilityFunctions::printerr("Ignoring malformed import cache ", manifest_path);
+		return;
+	}
+	Dictionary d = manifest;
+	if (int64_t(d.get("version", 0)) != CACHE_VERSION) {
+		return;
+	}
+	if (String(d.get("output_format", "text")) != output_format) {
+		return;
+	}
+	entries = d.get("entries", Dictionary());
+}
+
+Error ImportCache::save() const {
+	Ref<FileAccess> file = FileAccess::open(manifest_path, FileAccess::WRITE);
+	if (file.is_null()) {
+		UtilityFunctions::printerr("Could not write import cache ", manifest_path);
+		return FileAccess::get_open_error();
+	}
+	Dictionary manifest;
+	manifest["version"] = CACHE_VERSION;
+	manifest["output_format"] = output_format;
+	manifest["entries"] = entries;
+	file->store_string(JSON::stringify(manifest, "\t"));
+	return Error::OK;
+}
+
+bool ImportCache::lookup(const String &key, uint64_t &hash) const {
+	if (!entries.has(key)) {
+		return false;
+	}
+	Dictionary entry = entries[key];
+	if (!FileAccess::file_exists(entry.get("path", ""))) {
+		return false;
+	}
+	// String::hex_to_int is signed, so would reject half of our hashes
+	String hex = entry.get("hash", "");
+	if (hex.is_empty() || hex.length() > 16) {
+		return false;
+	}
+	hash = 0;
+	for (int64_t i = 0; i < hex.length(); ++ i) {
+		char32_t c = hex[i];
+		uint64_t digit;
+		if (c >= '0' && c <= '9') {
+			digit = c - '0';
+		} else if (c >= 'a' && c <= 'f') {
+			digit = c - 'a' + 10;
+		} else {
+			return false;
+		}
+		hash = (hash << 4) | digit;
+	}
+	return true;
+}
+
+bool ImportCache::is_fresh(const String &key, uint64_t hash) const {
+	uint64_t cached_hash;
+	return lookup(key, cached_hash) && cached_hash == hash;
+}
+
+String ImportCache::get_path(const String &key) const {
+	if (!entries.has(key)) {
+		return "";
+	}
+	Dictionary entry = entries[key];
+	return entry.get("path", "");
+}
+
+void ImportCache::record(const String &key, uint64_t hash, const String &path) {
+	Dictionary entry;
+	entry["hash"] = String::num_uint64(hash, 16);
+	entry["path"] = path;
+	entries[key] = entry;
+}
+
+}
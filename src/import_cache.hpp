@@ -0,0 +1,59 @@
+#ifndef LVLIMPORT_IMPORT_CACHE_HPP_
+#define LVLIMPORT_IMPORT_CACHE_HPP_
+
+#include <godot_cpp/variant/dictionary.hpp>
+#include <godot_cpp/variant/string.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+namespace godot {
+
+// 64 bit FNV-1a, fed a word at a time so hashing large vertex and texture
+// buffers stays cheap.
+class ContentHasher {
+	uint64_t hash = 14695981039346656037ULL;
+
+	void mix(uint64_t word) {
+		hash ^= word;
+		hash *= 1099511628211ULL;
+	}
+
+public:
+	void add_bytes(const void *data, size_t size);
+
+	template <typename T>
+	void add(const T &value) {
+		static_assert(std::is_trivially_copyable<T>::value, "hash POD values only");
+		add_bytes(&value, sizeof(T));
+	}
+
+	void add(const String &value);
+
+	uint64_t get() const { return hash; }
+};
+
+// Persistent record of the content hash each generated asset was built
+// from, keyed by its source chunk, so re-imports into the same scene_dir
+// can skip assets whose source hasn't changed. Entries are discarded when
+// the output format changes, since every output path changes with it.
+class ImportCache {
+	String manifest_path;
+	String output_format;
+	Dictionary entries; // key -> { "hash": hex String, "path": String }
+
+public:
+	void load(const String &scene_dir, const String &output_format);
+	Error save() const;
+
+	// Gets the hash key was last built from, if its output still exists
+	bool lookup(const String &key, uint64_t &hash) const;
+	// True if key was last built from this hash and its output still exists
+	bool is_fresh(const String &key, uint64_t hash) const;
+	String get_path(const String &key) const;
+	void record(const String &key, uint64_t hash, const String &path);
+};
+
+}
+
+#endif
@@ -0,0 +1,45 @@
+#include "import_log.hpp"
+#include <godot_cpp/variant/utility_functions.hpp>
+
+namespace godot {
+
+ImportLog::ImportLog(LogLevel level)
+	: level(level)
+{}
+
+ImportLog::~ImportLog() {
+	flush();
+}
+
+void ImportLog::flush_locked() {
+	if (buffered_lines == 0) {
+		return;
+	}
+	UtilityFunctions::print(buffer);
+	buffer = String();
+	buffered_lines = 0;
+}
+
+void ImportLog::push(LogLevel message_level, const String &line) {
+	std::lock_guard<std::mutex> lock(mutex);
+	if (message_level == LogLevel::Error) {
+		flush_locked();
+		UtilityFunctions::printerr(line);
+		return;
+	}
+	if (buffered_lines > 0) {
+		buffer += "\n";
+	}
+	buffer += line;
+	buffered_lines += 1;
+	if (buffered_lines >= FLUSH_LINES) {
+		flush_locked();
+	}
+}
+
+void ImportLog::flush() {
+	std::lock_guard<std::mutex> lock(mutex);
+	flush_locked();
+}
+
+}
@@ -0,0 +1,73 @@
+#ifndef LVLIMPORT_IMPORT_LOG_HPP_
+#define LVLIMPORT_IMPORT_LOG_HPP_
+
+#include <godot_cpp/variant/string.hpp>
+#include <godot_cpp/variant/string_name.hpp>
+#include <godot_cpp/variant/variant.hpp>
+#include <cstdint>
+#include <mutex>
+
+namespace godot {
+
+enum class LogLevel {
+	Off,
+	Error, // Only failures, printed with printerr
+	Info,  // One line per world, terrain, texture batch and saved scene
+	Trace, // One line per instance, entity class, model, bone and mesh
+};
+
+// Buffers log lines and prints them in batches, since every print is a
+// round trip to the editor's output panel. Errors flush whatever is
+// buffered and are printed straight away so they stay in order. Safe to
+// write from any thread.
+//
+// Use the LOG_* macros rather than write(), so the arguments of messages
+// below the active level are never evaluated or formatted.
+class ImportLog {
+	static constexpr uint32_t FLUSH_LINES = 256;
+
+	LogLevel level;
+	std::mutex mutex;
+	String buffer;
+	uint32_t buffered_lines = 0;
+
+	static void append(String &line, const String &value) { line += value; }
+	static void append(String &line, const char *value) { line += value; }
+	static void append(String &line, const StringName &value) { line += String(value); }
+	static void append(String &line, const Variant &value) { line += value.stringify(); }
+
+	void flush_locked();
+	void push(LogLevel message_level, const String &line);
+
+public:
+	ImportLog(LogLevel level);
+	~ImportLog();
+
+	bool enabled(LogLevel message_level) const {
+		return message_level != LogLevel::Off && message_level <= level;
+	}
+
+	template <typename... Args>
+	void write(LogLevel message_level, const Args &...args) {
+		String line;
+		(append(line, args), ...);
+		push(message_level, line);
+	}
+
+	void flush();
+};
+
+}
+
+#define LVLIMPORT_LOG(log, message_level, ...) \
+	do { \
+		if ((log).enabled(message_level)) { \
+			(log).write(message_level, __VA_ARGS__); \
+		} \
+	} while (0)
+
+#define LOG_ERROR(log, ...) LVLIMPORT_LOG(log, ::godot::LogLevel::Error, __VA_ARGS__)
+#define LOG_INFO(log, ...) LVLIMPORT_LOG(log, ::godot::LogLevel::Info, __VA_ARGS__)
+#define LOG_TRACE(log, ...) LVLIMPORT_LOG(log, ::godot::LogLevel::Trace, __VA_ARGS__)
+
+#endif
@@ -0,0 +1,82 @@
+#include "import_options.hpp"
+#include <godot_cpp/classes/resource_saver.hpp>
+#include <godot_cpp/core/defs.hpp>
+#include <godot_cpp/variant/utility_functions.hpp>
+
+namespace godot {
+
+ImportOptions ImportOptions::from_dictionary(const Dictionary &options) {
+	ImportOptions o;
+	int64_t thread_count = options.get("thread_count", 0);
+	o.thread_count = thread_count > 0 ? thread_count : 0;
+	int64_t terrain_chunks = options.get("terrain_chunks", 1);
+	o.terrain_chunks = CLAMP(terrain_chunks, 1, 64);
+	int64_t terrain_lod_levels = options.get("terrain_lod_levels", 3);
+	o.terrain_lod_levels = CLAMP(terrain_lod_levels, 0, 8);
+	o.terrain_collision = options.get("terrain_collision", true);
+	int64_t terrain_collision_tiles = options.get("terrain_collision_tiles", 1);
+	o.terrain_collision_tiles = CLAMP(terrain_collision_tiles, 1, 64);
+	double terrain_collision_spacing = options.get("terrain_collision_spacing", 0.0);
+	o.terrain_collision_spacing = terrain_collision_spacing > 0.0 ? terrain_collision_spacing : 0.0;
+	String texture_compression = options.get("texture_compression", "none");
+	if (texture_compression == "s3tc") {
+		o.texture_compression = TextureCompression::S3TC;
+	} else if (texture_compression == "etc2") {
+		o.texture_compression = TextureCompression::ETC2;
+	} else if (texture_compression != "none") {
+		UtilityFunctions::printerr("Unknown texture_compression ", texture_compression, "; textures will not be compressed");
+	}
+	o.use_cache = options.get("use_cache", true);
+	o.optimize_meshes = options.get("optimize_meshes", false);
+	o.merge_collision = options.get("merge_collision", false);
+	int64_t convex_collision_hulls = options.get("convex_collision_hulls", 0);
+	o.convex_collision_hulls = CLAMP(convex_collision_hulls, 0, 64);
+	double convex_collision_error = options.get("convex_collision_error", 0.02);
+	o.convex_collision_error = MAX(convex_collision_error, 0.0);
+	int64_t batch_instances = options.get("batch_instances", 0);
+	o.batch_instances = batch_instances > 0 ? batch_instances : 0;
+	o.report_path = options.get("report_path", "");
+	int64_t report_top_n = options.get("report_top_n", 10);
+	o.report_top_n = report_top_n > 0 ? report_top_n : 0;
+	String log_level = options.get("log_level", "info");
+	if (log_level == "off") {
+		o.log_level = LogLevel::Off;
+	} else if (log_level == "error") {
+		o.log_level = LogLevel::Error;
+	} else if (log_level == "trace") {
+		o.log_level = LogLevel::Trace;
+	} else if (log_level != "info") {
+		UtilityFunctions::printerr("Unknown log_level ", log_level, "; logging info");
+	}
+	String output_format = options.get("output_format", "text");
+	if (output_format == "binary") {
+		o.output_format = OutputFormat::Binary;
+	} else if (output_format == "binary_compressed") {
+		o.output_format = OutputFormat::BinaryCompressed;
+	} else if (output_format != "text") {
+		UtilityFunctions::printerr("Unknown output_format ", output_format, "; saving text resources");
+	}
+	return o;
+}
+
+String ImportOptions::get_output_format_name() const {
+	switch (output_format) {
+		case OutputFormat::Binary: return "binary";
+		case OutputFormat::BinaryCompressed: return "binary_compressed";
+		default: return "text";
+	}
+}
+
+String ImportOptions::get_scene_extension() const {
+	return output_format == OutputFormat::Text ? ".tscn" : ".scn";
+}
+
+String ImportOptions::get_resource_extension() const {
+	return output_format == OutputFormat::Text ? ".tres" : ".res";
+}
+
+uint32_t ImportOptions::get_saver_flags() const {
+	return output_format == OutputFormat::BinaryCompressed ? ResourceSaver::FLAG_COMPRESS : ResourceSaver::FLAG_NONE;
+}
+
+}
@@ -0,0 +1,114 @@
+#ifndef LVLIMPORT_IMPORT_OPTIONS_HPP_
+#define LVLIMPORT_IMPORT_OPTIONS_HPP_
+
+#include "import_log.hpp"
+#include "texture_stage.hpp"
+#include <godot_cpp/variant/dictionary.hpp>
+#include <godot_cpp/variant/string.hpp>
+#include <cstdint>
+
+namespace godot {
+
+enum class OutputFormat {
+	Text,             // .tscn and .tres
+	Binary,           // .scn and .res
+	BinaryCompressed, // .scn and .res compressed with ResourceSaver::FLAG_COMPRESS
+};
+
+// Options accepted by LVLImport.import_lvl. Unknown keys are ignored and
+// missing keys keep their defaults.
+struct ImportOptions {
+	// "thread_count": worker threads used by the parallel import stages.
+	// Zero uses every processor.
+	uint32_t thread_count = 0;
+
+	// "terrain_chunks": splits the terrain into an N x N grid of meshes so
+	// each can be culled independently. One keeps a single terrain mesh.
+	uint32_t terrain_chunks = 1;
+
+	// "terrain_lod_levels": coarser index buffers generated for each
+	// terrain chunk. Only used when terrain_chunks is greater than one.
+	uint32_t terrain_lod_levels = 3;
+
+	// "terrain_collision": adds a StaticBody3D to the terrain scene with
+	// HeightMapShape3D collision resampled from the terrain mesh.
+	bool terrain_collision = true;
+
+	// "terrain_collision_tiles": splits the terrain collision into an N x N
+	// grid of height map shapes so the physics engine can cull each one.
+	uint32_t terrain_collision_tiles = 1;
+
+	// "terrain_collision_spacing": distance between height map points.
+	// Zero matches the spacing of the terrain's own vertices.
+	float terrain_collision_spacing = 0;
+
+	// "texture_compression": "none" saves uncompressed RGBA8 textures and a
+	// PNG of each, "s3tc" saves mipmapped BC1/BC3/BC5 textures falling back
+	// to ETC2 where S3TC is unavailable, and "etc2" always uses ETC2.
+	TextureCompression texture_compression = TextureCompression::None;
+
+	// "use_cache": keeps a manifest of content hashes in scene_dir so
+	// re-imports skip textures, materials and entity classes whose source
+	// hasn't changed.
+	bool use_cache = true;
+
+	// "output_format": "text" writes .tscn scenes and .tres resources,
+	// "binary" writes .scn and .res, and "binary_compressed" also
+	// compresses them. Binary is far smaller and faster for Godot to load
+	// once terrain and collision arrays are embedded.
+	OutputFormat output_format = OutputFormat::Text;
+
+	// "batch_instances": entity classes with at least this many instances
+	// in a world are emitted as one MultiMeshInstance3D per mesh plus one
+	// StaticBody3D holding every instance's collision shapes, rather than
+	// a scene instance each. Only props and buildings without attachments
+	// are batched. Zero disables batching.
+	uint32_t batch_instances = 0;
+
+	// "optimize_meshes": reorders the triangles of every generated surface
+	// for the post-transform vertex cache and for overdraw, then reorders
+	// its vertices for fetch locality. ACMR before and after is logged at
+	// info for each surface, and the import report's "acmr_before" and
+	// "acmr_after" metrics give their mean and maximum over all surfaces.
+	bool optimize_meshes = false;
+
+	// "merge_collision": gives each model one StaticBody3D holding all of
+	// its collision shapes, each positioned relative to the model root by
+	// its bone's transform, rather than a body per collision primitive and
+	// another for the collision mesh. Cuts the physics bodies of worlds
+	// with many instances.
+	bool merge_collision = false;
+
+	// "convex_collision_hulls": replaces each model's concave collision mesh
+	// with at most this many convex hulls from an approximate convex
+	// decomposition, which Godot's physics collides with far faster. Zero
+	// keeps the ConcavePolygonShape3D.
+	uint32_t convex_collision_hulls = 0;
+
+	// "convex_collision_error": stops decomposing a collision mesh once its
+	// hulls cover no more than this fraction of its volume beyond it.
+	float convex_collision_error = 0.02f;
+
+	// "report_path": also writes the import report returned by import_lvl
+	// to this path as JSON. Empty writes nothing.
+	String report_path;
+
+	// "report_top_n": how many of the slowest assets the report lists.
+	uint32_t report_top_n = 10;
+
+	// "log_level": "off", "error", "info" or "trace". Info prints a line
+	// per import stage, trace also prints a line per instance, entity
+	// class, model, bone and mesh.
+	LogLevel log_level = LogLevel::Info;
+
+	String get_output_format_name() const;
+	String get_scene_extension() const;
+	String get_resource_extension() const;
+	uint32_t get_saver_flags() const;
+
+	static ImportOptions from_dictionary(const Dictionary &options);
+};
+
+}
+
+#endif
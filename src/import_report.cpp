@@ -0,0 +1,161 @@
+#include "import_report.hpp"
+#include <godot_cpp/classes/file_access.hpp>
+#include <godot_cpp/classes/json.hpp>
+#include <godot_cpp/variant/array.hpp>
+#include <godot_cpp/variant/utility_functions.hpp>
+#include <algorithm>
+#include <chrono>
+#include <ctime>
+
+namespace godot {
+
+ImportReport::ImportReport()
+	: start_wall_usec(wall_usec())
+	, start_cpu_usec(cpu_usec())
+{}
+
+uint64_t ImportReport::wall_usec() {
+	return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+uint64_t ImportReport::cpu_usec() {
+	return static_cast<uint64_t>(std::clock()) * 1000000 / CLOCKS_PER_SEC;
+}
+
+static void add_time(HashMap<String, ImportReport::Phase> &phases, const String &name, uint64_t wall_usec, uint64_t cpu_usec) {
+	if (!phases.has(name)) {
+		phases.insert(name, ImportReport::Phase());
+	}
+	ImportReport::Phase &phase = phases[name];
+	phase.wall_usec += wall_usec;
+	phase.cpu_usec += cpu_usec;
+	phase.calls += 1;
+}
+
+void ImportReport::add_phase(const String &phase, uint64_t wall_usec, uint64_t cpu_usec) {
+	add_time(phases, phase, wall_usec, cpu_usec);
+}
+
+void ImportReport::add_asset(const String &type, const String &name, uint64_t wall_usec, uint64_t cpu_usec) {
+	add_time(asset_types, type, wall_usec, cpu_usec);
+	assets.push_back({ type, name, wall_usec });
+}
+
+void ImportReport::add_count(const String &counter, int64_t amount) {
+	if (int64_t *count = counters.getptr(counter)) {
+		*count += amount;
+	} else {
+		counters.insert(counter, amount);
+	}
+}
+
+void ImportReport::add_metric(const String &metric, double value) {
+	if (!metrics.has(metric)) {
+		metrics.insert(metric, Metric());
+	}
+	Metric &m = metrics[metric];
+	m.max = m.samples ? std::max(m.max, value) : value;
+	m.sum += value;
+	m.samples += 1;
+}
+
+void ImportReport::add_file_written(const String &path) {
+	Ref<FileAccess> file = FileAccess::open(path, FileAccess::READ);
+	if (file.is_valid()) {
+		add_count("bytes_written", file->get_length());
+		add_count("files_written");
+	}
+}
+
+static Dictionary phases_to_dictionary(const HashMap<String, ImportReport::Phase> &phases) {
+	Dictionary d;
+	for (const KeyValue<String, ImportReport::Phase> &kv : phases) {
+		Dictionary phase;
+		phase["wall_usec"] = kv.value.wall_usec;
+		phase["cpu_usec"] = kv.value.cpu_usec;
+		phase["calls"] = kv.value.calls;
+		d[kv.key] = phase;
+	}
+	return d;
+}
+
+Dictionary ImportReport::to_dictionary(uint32_t top_n) const {
+	Dictionary d;
+	Dictionary total;
+	total["wall_usec"] = wall_usec() - start_wall_usec;
+	total["cpu_usec"] = cpu_usec() - start_cpu_usec;
+	d["total"] = total;
+	d["phases"] = phases_to_dictionary(phases);
+	d["asset_types"] = phases_to_dictionary(asset_types);
+
+	Dictionary counts;
+	for (const KeyValue<String, int64_t> &kv : counters) {
+		counts[kv.key] = kv.value;
+	}
+	d["counts"] = counts;
+
+	Dictionary metric_values;
+	for (const KeyValue<String, Metric> &kv : metrics) {
+		Dictionary metric;
+		metric["samples"] = kv.value.samples;
+		metric["mean"] = kv.value.sum / kv.value.samples;
+		metric["max"] = kv.value.max;
+		metric_values[kv.key] = metric;
+	}
+	d["metrics"] = metric_values;
+
+	std::vector<const Asset *> slowest;
+	slowest.reserve(assets.size());
+	for (const Asset &asset : assets) {
+		slowest.push_back(&asset);
+	}
+	uint32_t n = std::min<size_t>(top_n, slowest.size());
+	std::partial_sort(slowest.begin(), slowest.begin() + n, slowest.end(), [](const Asset *a, const Asset *b) {
+		return a->wall_usec > b->wall_usec;
+	});
+	Array slowest_assets;
+	for (uint32_t i = 0; i < n; ++ i) {
+		Dictionary asset;
+		asset["type"] = slowest[i]->type;
+		asset["name"] = slowest[i]->name;
+		asset["wall_usec"] = slowest[i]->wall_usec;
+		slowest_assets.push_back(asset);
+	}
+	d["slowest_assets"] = slowest_assets;
+	return d;
+}
+
+Error ImportReport::save_json(const String &path, uint32_t top_n) const {
+	Ref<FileAccess> file = FileAccess::open(path, FileAccess::WRITE);
+	if (file.is_null()) {
+		UtilityFunctions::printerr("Could not write import report ", path);
+		return FileAccess::get_open_error();
+	}
+	file->store_string(JSON::stringify(to_dictionary(top_n), "\t"));
+	return Error::OK;
+}
+
+ScopedPhase::ScopedPhase(ImportReport &report, const String &phase)
+	: report(report)
+	, phase(phase)
+	, start_wall_usec(ImportReport::wall_usec())
+	, start_cpu_usec(ImportReport::cpu_usec())
+{}
+
+ScopedPhase::~ScopedPhase() {
+	report.add_phase(phase, ImportReport::wall_usec() - start_wall_usec, ImportReport::cpu_usec() - start_cpu_usec);
+}
+
+ScopedAsset::ScopedAsset(ImportReport &report, const String &type, const String &name)
+	: report(report)
+	, type(type)
+	, name(name)
+	, start_wall_usec(ImportReport::wall_usec())
+	, start_cpu_usec(ImportReport::cpu_usec())
+{}
+
+ScopedAsset::~ScopedAsset() {
+	report.add_asset(type, name, ImportReport::wall_usec() - start_wall_usec, ImportReport::cpu_usec() - start_cpu_usec);
+}
+
+}
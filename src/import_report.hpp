@@ -0,0 +1,93 @@
+#ifndef LVLIMPORT_IMPORT_REPORT_HPP_
+#define LVLIMPORT_IMPORT_REPORT_HPP_
+
+#include <godot_cpp/templates/hash_map.hpp>
+#include <godot_cpp/variant/dictionary.hpp>
+#include <godot_cpp/variant/string.hpp>
+#include <cstdint>
+#include <vector>
+
+namespace godot {
+
+// Timings and counters collected over an import and returned to scripts by
+// LVLImport.import_lvl. Phases may nest, e.g. "terrain_mesh" runs within
+// "terrain", so phase times don't sum to the total. CPU time is process
+// time, so it includes every worker thread. Only the importing thread may
+// record into a report.
+class ImportReport {
+public:
+	struct Phase {
+		uint64_t wall_usec = 0;
+		uint64_t cpu_usec = 0;
+		uint32_t calls = 0;
+	};
+	struct Metric {
+		double sum = 0;
+		double max = 0;
+		uint32_t samples = 0;
+	};
+	struct Asset {
+		String type;
+		String name;
+		uint64_t wall_usec;
+	};
+
+private:
+	HashMap<String, Phase> phases;
+	HashMap<String, int64_t> counters;
+	HashMap<String, Metric> metrics;
+	HashMap<String, Phase> asset_types;
+	std::vector<Asset> assets;
+	uint64_t start_wall_usec;
+	uint64_t start_cpu_usec;
+
+public:
+	ImportReport();
+
+	static uint64_t wall_usec();
+	static uint64_t cpu_usec();
+
+	void add_phase(const String &phase, uint64_t wall_usec, uint64_t cpu_usec);
+	void add_asset(const String &type, const String &name, uint64_t wall_usec, uint64_t cpu_usec);
+	void add_count(const String &counter, int64_t amount = 1);
+	// Adds a sample to a metric, reported as its mean and maximum
+	void add_metric(const String &metric, double value);
+	// Adds the size of a file just written to "bytes_written"
+	void add_file_written(const String &path);
+
+	// { total: {wall_usec, cpu_usec}, phases: {name: {wall_usec, cpu_usec,
+	// calls}}, asset_types: {...}, counts: {name: int}, metrics: {name:
+	// {samples, mean, max}}, slowest_assets: [{type, name, wall_usec}] }
+	Dictionary to_dictionary(uint32_t top_n) const;
+	Error save_json(const String &path, uint32_t top_n) const;
+};
+
+// Adds the time between construction and destruction to a report phase
+class ScopedPhase {
+	ImportReport &report;
+	String phase;
+	uint64_t start_wall_usec;
+	uint64_t start_cpu_usec;
+
+public:
+	ScopedPhase(ImportReport &report, const String &phase);
+	~ScopedPhase();
+};
+
+// Adds the time between construction and destruction to a single asset,
+// which is ranked against every other asset and summed by type
+class ScopedAsset {
+	ImportReport &report;
+	String type;
+	String name;
+	uint64_t start_wall_usec;
+	uint64_t start_cpu_usec;
+
+public:
+	ScopedAsset(ImportReport &report, const String &type, const String &name);
+	~ScopedAsset();
+};
+
+}
+
+#endif
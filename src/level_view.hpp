@@ -0,0 +1,90 @@
+#ifndef LVLIMPORT_LEVEL_VIEW_HPP_
+#define LVLIMPORT_LEVEL_VIEW_HPP_
+
+#include <godot_cpp/variant/string.hpp>
+#include <LibSWBF2/API.h>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace godot {
+
+// The parts of a level that WorldImporter builds instances, entity classes,
+// models and materials from, in the layout LibSWBF2 returns them. The
+// importer reads these from its LibSWBF2 container, or from a
+// SyntheticWorld, so generated worlds go through the same code as real
+// levels. Buffer pointers are only valid while the view is being read.
+
+struct InstanceView {
+	String name;
+	String entity_class_name;
+	LibSWBF2::Vector3 position;
+	LibSWBF2::Vector4 rotation;
+};
+
+struct EntityClassView {
+	String base_name;
+	// (property hash, value) in the order the ODF lists them
+	std::vector<std::pair<uint32_t, String>> properties;
+};
+
+struct MaterialView {
+	bool present = false;
+	// Albedo and normal map, see WorldImporter::import_material. Names are
+	// empty for missing textures. Textures of synthetic worlds have names
+	// but no LibSWBF2 texture.
+	String texture_name[2];
+	const LibSWBF2::Texture *texture[2] = { nullptr, nullptr };
+	LibSWBF2::EMaterialFlags flags = LibSWBF2::EMaterialFlags(0);
+};
+
+// One segment's buffers in the layout LibSWBF2 returns them
+struct SegmentBuffers {
+	const LibSWBF2::Vector3 *vertex;
+	size_t vertex_count;
+	const LibSWBF2::Vector2 *tex_uv;
+	size_t tex_uv_count;
+	const LibSWBF2::Vector3 *normal;
+	size_t normal_count;
+	const uint16_t *index;
+	size_t index_count;
+	LibSWBF2::ETopology topology;
+};
+
+struct SegmentView {
+	String bone_name;
+	SegmentBuffers buffers;
+	MaterialView material;
+};
+
+struct BoneView {
+	String name;
+	String parent_name; // Empty for root bones
+	LibSWBF2::Vector3 position;
+	LibSWBF2::Vector4 rotation;
+};
+
+struct CollisionPrimitiveView {
+	String parent_name;
+	LibSWBF2::ECollisionPrimitiveType type;
+	// Cube half extents, cylinder radius and height, or sphere radius
+	float dims[3] = { 0.0f, 0.0f, 0.0f };
+	LibSWBF2::Vector3 position;
+	LibSWBF2::Vector4 rotation;
+};
+
+struct ModelView {
+	std::vector<BoneView> bones;
+	std::vector<SegmentView> segments;
+	std::vector<CollisionPrimitiveView> collision_primitives;
+	// Indexed triangle list, empty if the model has no collision mesh
+	const LibSWBF2::Vector3 *collision_vertex = nullptr;
+	size_t collision_vertex_count = 0;
+	const uint16_t *collision_index = nullptr;
+	size_t collision_index_count = 0;
+};
+
+}
+
+#endif
@@ -1,17 +1,43 @@
 #include "lvlimport.hpp"
+#include "async_import.hpp"
+#include "convex_decompose.hpp"
+#include "import_cache.hpp"
+#include "import_log.hpp"
+#include "fnv.hpp"
+#include "import_options.hpp"
+#include "import_report.hpp"
+#include "level_view.hpp"
+#include "mesh_optimize.hpp"
+#include "normal_kernel.hpp"
+#include "packed_convert.hpp"
+#include "string_intern.hpp"
+#include "synthetic_world.hpp"
+#include "triangle_strip.hpp"
+#include "terrain_blend.hpp"
+#include "terrain_chunks.hpp"
+#include "terrain_collision.hpp"
+#include "terrain_mesh.hpp"
+#include "texture_stage.hpp"
+#include "worker_pool.hpp"
 #include <godot_cpp/classes/collision_shape3d.hpp>
 #include <godot_cpp/classes/concave_polygon_shape3d.hpp>
+#include <godot_cpp/classes/convex_polygon_shape3d.hpp>
 #include <godot_cpp/classes/cylinder_shape3d.hpp>
 #include <godot_cpp/classes/box_shape3d.hpp>
 #include <godot_cpp/classes/dir_access.hpp>
+#include <godot_cpp/classes/file_access.hpp>
+#include <godot_cpp/classes/height_map_shape3d.hpp>
 #include <godot_cpp/classes/image.hpp>
 #include <godot_cpp/classes/image_texture.hpp>
 #include <godot_cpp/classes/mesh_instance3d.hpp>
+#include <godot_cpp/classes/multi_mesh.hpp>
+#include <godot_cpp/classes/multi_mesh_instance3d.hpp>
 #include <godot_cpp/classes/node3d.hpp>
 #include <godot_cpp/classes/os.hpp>
 #include <godot_cpp/classes/packed_scene.hpp>
 #include <godot_cpp/classes/resource_loader.hpp>
 #include <godot_cpp/classes/resource_saver.hpp>
+#include <godot_cpp/classes/shader.hpp>
 #include <godot_cpp/classes/shader_material.hpp>
 #include <godot_cpp/classes/sphere_shape3d.hpp>
 #include <godot_cpp/classes/standard_material3d.hpp>
@@ -19,20 +45,46 @@
 #include <godot_cpp/core/class_db.hpp>
 #include <godot_cpp/variant/utility_functions.hpp>
 #include <godot_cpp/templates/hash_map.hpp>
+#include <godot_cpp/templates/hash_set.hpp>
 #include <LibSWBF2/API.h>
 #include <atomic>
+#include <cmath>
+#include <deque>
+#include <functional>
 #include <utility>
-#include <float.h>
+#include <vector>
 
 using namespace LibSWBF2;
 
 namespace godot {
 
 class WorldImporter {
+	ImportOptions options;
+	ImportLog logger;
+	WorkerPool pool;
 	Container_Owned *container;
-	HashMap<String, String> entity_class_scenes;
+	HashMap<String, Ref<PackedScene>> entity_class_scenes;
 	HashMap<String, Ref<ImageTexture>> textures;
 	HashMap<String, Ref<StandardMaterial3D>> materials; // key = albedo texture name
+	HashMap<String, uint64_t> entity_class_hashes;
+	ImportCache cache;
+	StringInterner strings;
+	ImportReport report;
+	AsyncImport *async; // Set when importing on a background thread
+	// Set while importing a synthetic world, which level data is then read
+	// from instead of the container
+	const SyntheticWorld *synthetic = nullptr;
+	// Output that didn't exist before this import, removed if it's cancelled
+	std::vector<String> created_files;
+	std::vector<String> created_dirs;
+
+	// Instances of one entity class flattened into meshes and collision
+	// shapes relative to the instance origin
+	struct InstanceBatch {
+		std::vector<std::pair<Ref<Mesh>, Transform3D>> meshes;
+		std::vector<std::pair<Ref<Shape3D>, Transform3D>> shapes;
+		std::vector<Transform3D> instances;
+	};
 
 	String make_name_valid(const String &name)
 	{
@@ -43,336 +95,769 @@ class WorldImporter {
 		return name;
 	}
 
+	// Most API strings fit on the stack, so only longer ones need the
+	// length query and a second call
 	template<typename Fn, typename ...Args>
-	static String api_str_to_godot(Fn &&fn, Args && ...args)
+	const String &api_str_to_godot(Fn &&fn, Args && ...args)
 	{
-		size_t len = fn(args..., nullptr, 0);
+		char stack_buffer[256];
+		size_t len = fn(args..., stack_buffer, sizeof(stack_buffer));
+		if (len < sizeof(stack_buffer)) {
+			return strings.intern(stack_buffer, len);
+		}
 		std::string buffer(len + 1, '\0');
 		fn(args..., buffer.data(), len + 1);
-		return String::utf8(buffer.c_str());
+		return strings.intern(buffer.data(), len);
+	}
+
+	bool is_cancelled() const {
+		return async != nullptr && async->cancel_requested;
+	}
+
+	void set_progress(const String &phase, int64_t done, int64_t total) {
+		if (async != nullptr) {
+			async->set_progress(phase, done, total);
+		}
 	}
 
-	Node *import_world(const World *world, const String &scene_dir) {
+	// Godot's resource cache, loader and saver are shared with the editor,
+	// so background imports use them from the main thread
+	void on_main_thread(const std::function<void()> &fn) {
+		if (async != nullptr) {
+			async->call_on_main_thread(fn);
+		} else {
+			fn();
+		}
+	}
+
+	Ref<Resource> load_resource(const String &path) {
+		Ref<Resource> resource;
+		on_main_thread([&] {
+			resource = ResourceLoader::get_singleton()->load(path);
+		});
+		return resource;
+	}
+
+	// Level data is read through these views, from the container or from
+	// the synthetic world being imported, see level_view.hpp
+	std::vector<InstanceView> read_instances(const World *world) {
+		TList<const Instance> instances = World_GetInstancesT(world);
+		std::vector<InstanceView> views(instances.size());
+		for (size_t i = 0; i < instances.size(); ++ i) {
+			const Instance *instance = instances.at(i);
+			views[i].name = api_str_to_godot(Instance_GetName, instance);
+			views[i].entity_class_name = api_str_to_godot(Instance_GetEntityClassName, instance);
+			views[i].position = Instance_GetPosition(instance);
+			views[i].rotation = Instance_GetRotation(instance);
+		}
+		return views;
+	}
+
+	bool read_entity_class(const String &entity_class_name, EntityClassView &out) {
+		if (synthetic) {
+			return synthetic->get_entity_class(entity_class_name, out);
+		}
+		const EntityClass *entity_class = Container_FindEntityClass(container, strings.hash(entity_class_name));
+		if (entity_class == nullptr) {
+			return false;
+		}
+		out.base_name = api_str_to_godot(EntityClass_GetBaseName, entity_class);
+		TList<uint32_t> property_hashes = EntityClass_GetAllPropertyHashesT(entity_class);
+		out.properties.resize(property_hashes.size());
+		for (size_t pi = 0; pi < property_hashes.size(); ++ pi) {
+			uint32_t property_hash = *property_hashes.at(pi);
+			out.properties[pi] = { property_hash, api_str_to_godot(EntityClass_GetPropertyValue, entity_class, property_hash) };
+		}
+		return true;
+	}
+
+	MaterialView read_material(const LibSWBF2::Material *material) {
+		MaterialView view;
+		if (material == nullptr) {
+			return view;
+		}
+		view.present = true;
+		for (int slot = 0; slot < 2; ++ slot) {
+			if (const LibSWBF2::Texture *texture = Material_GetTexture(material, slot)) {
+				view.texture[slot] = texture;
+				view.texture_name[slot] = api_str_to_godot(Texture_GetName, texture);
+			}
+		}
+		view.flags = Material_GetFlags(material);
+		return view;
+	}
+
+	// Calls fn with a view of the model, whose buffers are only valid
+	// during the call. False if there is no such model.
+	bool read_model(const String &model_name, const std::function<void(const ModelView &)> &fn) {
+		ModelView view;
+		if (synthetic) {
+			if (!synthetic->get_model(model_name, view)) {
+				return false;
+			}
+			fn(view);
+			return true;
+		}
+		const Model *model = Container_FindModel(container, strings.hash(model_name));
+		if (model == nullptr) {
+			return false;
+		}
+
+		TList<const Bone> bones = Model_GetBonesT(model);
+		view.bones.resize(bones.size());
+		for (size_t i = 0; i < bones.size(); ++ i) {
+			const Bone *bone = bones.at(i);
+			view.bones[i].name = api_str_to_godot(Bone_GetName, bone);
+			view.bones[i].parent_name = api_str_to_godot(Bone_GetParentName, bone);
+			view.bones[i].position = Bone_GetPosition(bone);
+			view.bones[i].rotation = Bone_GetRotation(bone);
+		}
+
+		// Keeps each segment's buffers alive until fn returns. TLists are
+		// built in place, nothing says they can be moved.
+		struct SegmentLists {
+			TList<uint16_t> index;
+			TList<const LibSWBF2::Vector3> vertex;
+			TList<const LibSWBF2::Vector2> tex_uv;
+			TList<const LibSWBF2::Vector3> normal;
+
+			SegmentLists(const Segment *segment)
+				: index(Segment_GetIndexBufferT(segment))
+				, vertex(Segment_GetVertexBufferT(segment))
+				, tex_uv(Segment_GetUVBufferT(segment))
+				, normal(Segment_GetNormalBufferT(segment))
+			{}
+		};
+		TList<const Segment> segments = Model_GetSegmentsT(model);
+		std::deque<SegmentLists> segment_lists;
+		view.segments.resize(segments.size());
+		for (size_t i = 0; i < segments.size(); ++ i) {
+			const Segment *segment = segments.at(i);
+			SegmentLists &lists = segment_lists.emplace_back(segment);
+			SegmentView &segment_view = view.segments[i];
+			segment_view.bone_name = api_str_to_godot(Segment_GetBoneName, segment);
+			segment_view.buffers = {
+				lists.vertex.data(), lists.vertex.size(),
+				lists.tex_uv.data(), lists.tex_uv.size(),
+				lists.normal.data(), lists.normal.size(),
+				lists.index.data(), lists.index.size(),
+				Segment_GetTopology(segment),
+			};
+			segment_view.material = read_material(Segment_GetMaterial(segment));
+		}
+
+		TList<const CollisionPrimitive> collision_primitives = Model_GetCollisionPrimitivesT(model);
+		view.collision_primitives.resize(collision_primitives.size());
+		for (size_t i = 0; i < collision_primitives.size(); ++ i) {
+			const CollisionPrimitive *collision_primitive = collision_primitives.at(i);
+			CollisionPrimitiveView &primitive = view.collision_primitives[i];
+			primitive.parent_name = api_str_to_godot(CollisionPrimitive_GetParentName, collision_primitive);
+			primitive.type = CollisionPrimitive_GetType(collision_primitive);
+			switch (primitive.type) {
+				case ECollisionPrimitiveType::Cube:
+					CollisionPrimitive_GetCubeDims(collision_primitive, &primitive.dims[0], &primitive.dims[1], &primitive.dims[2]);
+					break;
+				case ECollisionPrimitiveType::Cylinder:
+					CollisionPrimitive_GetCylinderDims(collision_primitive, &primitive.dims[0], &primitive.dims[1]);
+					break;
+				case ECollisionPrimitiveType::Sphere:
+					CollisionPrimitive_GetSphereRadius(collision_primitive, &primitive.dims[0]);
+					break;
+				default:
+					break;
+			}
+			primitive.position = CollisionPrimitive_GetPosition(collision_primitive);
+			primitive.rotation = CollisionPrimitive_GetRotation(collision_primitive);
+		}
+
+		// A model always has a collision mesh object, but it may be empty
+		const CollisionMesh *collision_mesh = Model_GetCollisionMesh(model);
+		TList<uint16_t> collision_index_buffer = CollisionMesh_GetIndexBufferT(collision_mesh);
+		TList<LibSWBF2::Vector3> collision_vertex_buffer = CollisionMesh_GetVertexBufferT(collision_mesh);
+		view.collision_index = collision_index_buffer.data();
+		view.collision_index_count = collision_index_buffer.size();
+		view.collision_vertex = collision_vertex_buffer.data();
+		view.collision_vertex_count = collision_vertex_buffer.size();
+
+		fn(view);
+		return true;
+	}
+
+	Node *import_world(const World *world, const String &scene_dir, const String &asset_dir) {
 		String world_name = api_str_to_godot(World_GetName, world);
-		printdebug("Importing world ", world_name);
+		LOG_INFO(logger, "Importing world ", world_name);
 
 		Node *world_root = memnew(Node);
 		if (world_root == nullptr) {
-			UtilityFunctions::printerr("memnew failed to allocate a Node");
+			LOG_ERROR(logger, "memnew failed to allocate a Node");
 			return nullptr;
 		}
 		world_root->set_name(make_name_valid(world_name));
 
-		// Import instances
-		TList<const Instance> instances = World_GetInstancesT(world);
+		// Import every referenced texture in parallel up front
+		std::vector<InstanceView> instances = read_instances(world);
+		{
+			ScopedPhase phase(report, "world_textures");
+			find_cached_entity_classes(instances);
+			import_world_textures(world, instances, asset_dir);
+		}
+		if (is_cancelled()) {
+			return world_root;
+		}
+
+		import_instances(instances, world_root, asset_dir);
+
+		// Import terrain
+		if (is_cancelled()) {
+			return world_root;
+		}
+		set_progress("terrain", 0, 1);
+		{
+			ScopedPhase phase(report, "terrain");
+			if (Node *terrain = import_terrain(world, scene_dir, asset_dir)) {
+				make_parent_and_owner(world_root, terrain);
+			}
+		}
+
+
+		// Import skydome
+		if (is_cancelled()) {
+			return world_root;
+		}
+		set_progress("skydome", 0, 1);
+		{
+			ScopedPhase phase(report, "skydome");
+			if (Node *skydome = import_skydome(world, asset_dir)) {
+				make_parent_and_owner(world_root, skydome);
+			}
+		}
+
+		return world_root;
+	}
+
+	void import_instances(const std::vector<InstanceView> &instances, Node *world_root, const String &asset_dir) {
+		ScopedPhase phase(report, "instances");
+		report.add_count("instances", instances.size());
+		HashMap<String, InstanceBatch> batches;
+		if (options.batch_instances > 0) {
+			find_instance_batches(instances, asset_dir, batches);
+		}
 		for (size_t i = 0; i < instances.size(); ++ i) {
-			const Instance *instance = instances.at(i);
-			String instance_name = api_str_to_godot(Instance_GetName, instance);
-			String entity_class_name = api_str_to_godot(Instance_GetEntityClassName, instance);
-			printdebug("Importing instance ", i, "/", instances.size(), " '", instance_name, "'");
-			Node3D *instance_node = import_entity_class(entity_class_name, scene_dir);
+			if (is_cancelled()) {
+				return;
+			}
+			set_progress("instances", i, instances.size());
+			const InstanceView &instance = instances[i];
+			const LibSWBF2::Vector3 &pz = instance.position;
+			const LibSWBF2::Vector4 &rz = instance.rotation;
+			if (InstanceBatch *batch = batches.getptr(instance.entity_class_name)) {
+				batch->instances.push_back(Transform3D(Basis(Quaternion(rz.m_X, rz.m_Y, rz.m_Z, rz.m_W)), Vector3(pz.m_X, pz.m_Y, pz.m_Z)));
+				continue;
+			}
+			LOG_TRACE(logger, "Importing instance ", i, "/", instances.size(), " '", instance.name, "'");
+			Node3D *instance_node = import_entity_class(instance.entity_class_name, asset_dir);
 			if (instance_node) {
-				printdebug("Attaching instance '", instance_name, "' to world");
-				instance_node->set_name(make_name_valid(instance_name));
-				LibSWBF2::Vector3 pz = Instance_GetPosition(instance);
-				LibSWBF2::Vector4 rz = Instance_GetRotation(instance);
+				LOG_TRACE(logger, "Attaching instance '", instance.name, "' to world");
+				instance_node->set_name(make_name_valid(instance.name));
 				instance_node->set_position(Vector3(pz.m_X, pz.m_Y, pz.m_Z));
 				instance_node->set_quaternion(Quaternion(rz.m_X, rz.m_Y, rz.m_Z, rz.m_W));
 				make_parent_and_owner(world_root, instance_node);
 			} else {
-				UtilityFunctions::printerr("Failed to import instance '", instance_name, "'");
+				LOG_ERROR(logger, "Failed to import instance '", instance.name, "'");
+			}
+		}
+		for (const KeyValue<String, InstanceBatch> &batch : batches) {
+			if (Node3D *batch_node = create_instance_batch(batch.key, batch.value)) {
+				make_parent_and_owner(world_root, batch_node);
 			}
 		}
+	}
 
-		// Import terrain
-		if (Node *terrain = import_terrain(world, scene_dir)) {
-			make_parent_and_owner(world_root, terrain);
+	// Accumulates the meshes and collision shapes of an entity class scene
+	// relative to its root. Returns false if the scene contains anything a
+	// batch can't represent, such as an attached entity class scene.
+	static bool flatten_instance(Node *node, const Transform3D &parent_transform, InstanceBatch &batch) {
+		Transform3D transform = parent_transform;
+		if (Node3D *node3d = Node::cast_to<Node3D>(node)) {
+			transform = parent_transform * node3d->get_transform();
 		}
+		if (MeshInstance3D *mesh_instance = Node::cast_to<MeshInstance3D>(node)) {
+			if (mesh_instance->get_mesh().is_valid()) {
+				batch.meshes.push_back({ mesh_instance->get_mesh(), transform });
+			}
+		} else if (CollisionShape3D *collision_shape = Node::cast_to<CollisionShape3D>(node)) {
+			if (collision_shape->get_shape().is_valid()) {
+				batch.shapes.push_back({ collision_shape->get_shape(), transform });
+			}
+		}
+		for (int64_t i = 0; i < node->get_child_count(); ++ i) {
+			Node *child = node->get_child(i);
+			if (child->get_scene_file_path().length() > 0) {
+				return false; // Attachment
+			}
+			if (!flatten_instance(child, transform, batch)) {
+				return false;
+			}
+		}
+		return true;
+	}
 
+	// Finds the entity classes instanced often enough to batch, and whose
+	// instances are static and need no nodes of their own
+	void find_instance_batches(const std::vector<InstanceView> &instances, const String &asset_dir, HashMap<String, InstanceBatch> &batches) {
+		HashMap<String, uint32_t> instance_counts;
+		for (const InstanceView &instance : instances) {
+			if (uint32_t *count = instance_counts.getptr(instance.entity_class_name)) {
+				*count += 1;
+			} else {
+				instance_counts.insert(instance.entity_class_name, 1);
+			}
+		}
+		for (const KeyValue<String, uint32_t> &instance_count : instance_counts) {
+			const String &entity_class_name = instance_count.key;
+			if (instance_count.value < options.batch_instances) {
+				continue;
+			}
+			EntityClassView entity_class;
+			if (!read_entity_class(entity_class_name, entity_class)) {
+				continue;
+			}
+			if (entity_class.base_name != "prop" && entity_class.base_name != "building") {
+				continue;
+			}
+			Node3D *instance_node = import_entity_class(entity_class_name, asset_dir);
+			if (instance_node == nullptr) {
+				continue;
+			}
+			InstanceBatch batch;
+			if (flatten_instance(instance_node, Transform3D(), batch) && !batch.meshes.empty()) {
+				LOG_INFO(logger, "Batching ", instance_count.value, " instances of ", entity_class_name);
+				batches.insert(entity_class_name, batch);
+			}
+			memdelete(instance_node);
+		}
+	}
 
-		// Import skydome
-		if (Node *skydome = import_skydome(world, scene_dir)) {
-			make_parent_and_owner(world_root, skydome);
+	// One MultiMeshInstance3D per mesh of the entity class, and a single
+	// StaticBody3D with a CollisionShape3D per instance and shape. Every
+	// instance shares the entity class's Mesh and Shape3D resources.
+	Node3D *create_instance_batch(const String &entity_class_name, const InstanceBatch &batch) {
+		Node3D *batch_root = memnew(Node3D);
+		if (batch_root == nullptr) {
+			LOG_ERROR(logger, "memnew failed to allocate a Node3D");
+			return nullptr;
+		}
+		batch_root->set_name(make_name_valid(entity_class_name + "_batch"));
+
+		const int32_t instance_count = batch.instances.size();
+		for (size_t m = 0; m < batch.meshes.size(); ++ m) {
+			const Ref<Mesh> &mesh = batch.meshes[m].first;
+			const Transform3D &mesh_transform = batch.meshes[m].second;
+			Ref<MultiMesh> multimesh;
+			multimesh.instantiate();
+			multimesh->set_transform_format(MultiMesh::TRANSFORM_3D);
+			multimesh->set_mesh(mesh);
+			multimesh->set_instance_count(instance_count);
+			for (int32_t i = 0; i < instance_count; ++ i) {
+				multimesh->set_instance_transform(i, batch.instances[i] * mesh_transform);
+			}
+			MultiMeshInstance3D *multimesh_instance = memnew(MultiMeshInstance3D);
+			if (multimesh_instance == nullptr) {
+				LOG_ERROR(logger, "memnew failed to allocate a MultiMeshInstance3D");
+				continue;
+			}
+			multimesh_instance->set_name(make_name_valid(entity_class_name + "_multimesh_" + itos(m)));
+			multimesh_instance->set_multimesh(multimesh);
+			make_parent_and_owner(batch_root, multimesh_instance);
 		}
 
-		return world_root;
+		if (!batch.shapes.empty()) {
+			StaticBody3D *static_body = memnew(StaticBody3D);
+			if (static_body == nullptr) {
+				LOG_ERROR(logger, "memnew failed to allocate a StaticBody3D");
+				return batch_root;
+			}
+			static_body->set_name(make_name_valid(entity_class_name + "_collision"));
+			make_parent_and_owner(batch_root, static_body);
+			for (int32_t i = 0; i < instance_count; ++ i) {
+				for (size_t s = 0; s < batch.shapes.size(); ++ s) {
+					CollisionShape3D *collision_shape = memnew(CollisionShape3D);
+					if (collision_shape == nullptr) {
+						LOG_ERROR(logger, "memnew failed to allocate a CollisionShape3D");
+						continue;
+					}
+					collision_shape->set_name("shape_" + itos(i) + "_" + itos(s));
+					collision_shape->set_shape(batch.shapes[s].first);
+					collision_shape->set_transform(batch.instances[i] * batch.shapes[s].second);
+					make_parent_and_owner(static_body, collision_shape);
+				}
+			}
+		}
+		return batch_root;
 	}
 
 	Node3D *maybe_instantiate_entity_class(const String &entity_class_name) {
 		if (entity_class_scenes.has(entity_class_name)) {
-			String scene_path = entity_class_scenes.get(entity_class_name);
-			Ref<PackedScene> scene = ResourceLoader::get_singleton()->load(scene_path);
-			if (scene->can_instantiate()) {
+			Ref<PackedScene> scene = entity_class_scenes.get(entity_class_name);
+			if (scene.is_valid() && scene->can_instantiate()) {
 				Node3D *instance = Node::cast_to<Node3D>(scene->instantiate());
 				if (instance == nullptr) {
-					UtilityFunctions::printerr("Entity class ", entity_class_name, " scene instantiation failed");
+					LOG_ERROR(logger, "Entity class ", entity_class_name, " scene instantiation failed");
 					return nullptr;
 				}
 				return instance;
 			} else {
-				UtilityFunctions::printerr("Entity class ", entity_class_name, " scene cannot be instantiated");
+				LOG_ERROR(logger, "Entity class ", entity_class_name, " scene cannot be instantiated");
 			}
 		}
 		return nullptr;
 	}
 
-	Node3D *import_skydome(const World *world, const String &scene_dir) {
-		printdebug("Importing skydome");
-		const Config *skydome_config = Container_FindConfig(
+	const Config *find_skydome_config(const World *world) {
+		return Container_FindConfig(
 				container,
 				EConfigType::Skydome,
-				FNVHashString(api_str_to_godot(World_GetSkyName, world).utf8())
+				strings.hash(api_str_to_godot(World_GetSkyName, world))
 		);
-		if (skydome_config == nullptr) {
-			return nullptr;
-		}
+	}
 
-		Node3D *skydome = memnew(Node3D);
-		if (skydome == nullptr) {
-			UtilityFunctions::printerr("Failed to create skydome node");
-			return nullptr;
-		}
-		skydome->set_name(make_name_valid("skydome"));
-		skydome->set_scale(Vector3(300, 300, 300));
+	std::vector<String> get_skydome_model_names(const Config *skydome_config) {
+		std::vector<String> model_names;
 
 		// TODO: This LibSWBF2 code may throw an exception! But Godot does not compile with exceptions!
-		const Field *dome_info = Config_GetField(skydome_config, FNVHashString("DomeInfo"));
-		TList<const Field *> dome_models = Scope_GetFieldsT(Field_GetScope(dome_info), FNVHashString("DomeModel"));
-		printdebug("Skydome has ", dome_models.size(), " dome models");
+		const Field *dome_info = Config_GetField(skydome_config, fnv_hash("DomeInfo"));
+		TList<const Field *> dome_models = Scope_GetFieldsT(Field_GetScope(dome_info), fnv_hash("DomeModel"));
+		LOG_TRACE(logger, "Skydome has ", dome_models.size(), " dome models");
 		for (size_t i = 0; i < dome_models.size(); ++ i) {
 			const Field *f = *dome_models.at(i);
-			String model_name = api_str_to_godot(Field_GetString, Scope_GetField(Field_GetScope(f), FNVHashString("Geometry")), 0);
-			printdebug("Importing skydome model ", i, "/",  dome_models.size(), " ", model_name);
-			populate_model(skydome, model_name, "", scene_dir);
+			model_names.push_back(api_str_to_godot(Field_GetString, Scope_GetField(Field_GetScope(f), fnv_hash("Geometry")), 0));
 		}
 
-		// Create sky objects
-		TList<const Field *> sky_objects = Config_GetFieldsT(skydome_config, FNVHashString("SkyObject"));
-		printdebug("Skydome has ", sky_objects.size(), " sky objects");
+		// Sky objects
+		TList<const Field *> sky_objects = Config_GetFieldsT(skydome_config, fnv_hash("SkyObject"));
+		LOG_TRACE(logger, "Skydome has ", sky_objects.size(), " sky objects");
 		for (size_t i = 0; i < sky_objects.size(); ++ i) {
 			const Field *f = *sky_objects.at(i);
-			String model_name = api_str_to_godot(Field_GetString, Scope_GetField(Field_GetScope(f), FNVHashString("Geometry")), 0);
+			String model_name = api_str_to_godot(Field_GetString, Scope_GetField(Field_GetScope(f), fnv_hash("Geometry")), 0);
 			// This alternate behavior mimicks that of the .NET Scope wrapper from LibSWBF2 definition of GetString
 			if (model_name == "") {
-				model_name = api_str_to_godot(Field_GetString, f, FNVHashString("Geometry"));
+				model_name = api_str_to_godot(Field_GetString, f, fnv_hash("Geometry"));
 			}
-			printdebug("Importing sky object ", i, "/",  sky_objects.size(), " ", model_name);
-			populate_model(skydome, model_name, "", scene_dir);
+			model_names.push_back(model_name);
 		}
 
-		return skydome;
+		return model_names;
 	}
 
-	MeshInstance3D *import_terrain(const World *world, const String &scene_dir) {
-		const Terrain *terrain = World_GetTerrain(world);
-		if (terrain == nullptr) {
+	Node3D *import_skydome(const World *world, const String &asset_dir) {
+		LOG_INFO(logger, "Importing skydome");
+		const Config *skydome_config = find_skydome_config(world);
+		if (skydome_config == nullptr) {
 			return nullptr;
 		}
 
-		String terrain_name = api_str_to_godot(World_GetTerrainName, world);
+		Node3D *skydome = memnew(Node3D);
+		if (skydome == nullptr) {
+			LOG_ERROR(logger, "Failed to create skydome node");
+			return nullptr;
+		}
+		skydome->set_name(make_name_valid("skydome"));
+		ScopedAsset asset(report, "skydome", api_str_to_godot(World_GetSkyName, world));
+		skydome->set_scale(Vector3(300, 300, 300));
+
+		// Dome models and sky objects
+		std::vector<String> model_names = get_skydome_model_names(skydome_config);
+		NodeIndex node_index;
+		for (size_t i = 0; i < model_names.size(); ++ i) {
+			LOG_TRACE(logger, "Importing skydome model ", (int64_t)i, "/", (int64_t)model_names.size(), " ", model_names[i]);
+			populate_model(skydome, node_index, model_names[i], "", asset_dir);
+		}
 
-		// Create the terrain mesh
+		return skydome;
+	}
+
+	void count_surface(const Array &mesh_data) {
+		report.add_count("surfaces");
+		report.add_count("vertices", PackedVector3Array(mesh_data[Mesh::ArrayType::ARRAY_VERTEX]).size());
+		report.add_count("triangles", PackedInt32Array(mesh_data[Mesh::ArrayType::ARRAY_INDEX]).size() / 3);
+	}
+
+	void optimize_surface(Array &mesh_data, Dictionary &lods, const String &mesh_name) {
+		if (!options.optimize_meshes) {
+			return;
+		}
+		ScopedPhase phase(report, "mesh_optimize");
+		MeshOptimizeReport optimized = optimize_surface_arrays(mesh_data, lods);
+		if (optimized.optimized) {
+			LOG_INFO(logger, "Optimized ", mesh_name, " ACMR ", optimized.acmr_before, " -> ", optimized.acmr_after);
+			report.add_metric("acmr_before", optimized.acmr_before);
+			report.add_metric("acmr_after", optimized.acmr_after);
+		} else if (PackedInt32Array(mesh_data[Mesh::ArrayType::ARRAY_INDEX]).size() >= 3) {
+			LOG_ERROR(logger, "Could not optimize ", mesh_name, "; indices out of range");
+		}
+	}
+
+	MeshInstance3D *create_terrain_mesh_instance(const PackedVector3Array &vertex, const PackedVector3Array &normal,
+	                                             const PackedVector2Array &tex_uv, const PackedVector2Array &blend_uv,
+	                                             const PackedInt32Array &index, const Dictionary &lods,
+	                                             const Ref<ShaderMaterial> &terrain_material) {
 		MeshInstance3D *terrain_mesh = memnew(MeshInstance3D);
 		if (terrain_mesh == nullptr) {
-			UtilityFunctions::printerr("Failed to create terrain mesh");
+			LOG_ERROR(logger, "Failed to create terrain mesh");
 			return nullptr;
 		}
-		terrain_mesh->set_name(make_name_valid(terrain_name));
 
 		Ref<ArrayMesh> array_mesh;
 		array_mesh.instantiate();
 
 		Array mesh_data;
 		mesh_data.resize(Mesh::ArrayType::ARRAY_MAX);
+		mesh_data[Mesh::ArrayType::ARRAY_VERTEX] = vertex;
+		mesh_data[Mesh::ArrayType::ARRAY_NORMAL] = normal;
+		if (!tex_uv.is_empty()) {
+			mesh_data[Mesh::ArrayType::ARRAY_TEX_UV] = tex_uv;
+		}
+		mesh_data[Mesh::ArrayType::ARRAY_TEX_UV2] = blend_uv;
+		mesh_data[Mesh::ArrayType::ARRAY_INDEX] = index;
 
-		PackedVector3Array vertex;
-		PackedVector3Array normal;
-		PackedVector2Array tex_uv;
-		PackedVector2Array blend_uv;
-		PackedInt32Array index;
+		Dictionary surface_lods = lods.duplicate();
+		optimize_surface(mesh_data, surface_lods, "terrain");
+		count_surface(mesh_data);
 
-		TList<uint32_t> index_buffer = Terrain_GetIndexBufferT(terrain);
-		TList<const LibSWBF2::Vector3> vertex_buffer = Terrain_GetVertexBufferT(terrain);
-		TList<const LibSWBF2::Vector2> tex_uv_buffer = Terrain_GetUVBufferT(terrain);
+		array_mesh->add_surface_from_arrays(Mesh::PrimitiveType::PRIMITIVE_TRIANGLES, mesh_data, Array(), surface_lods);
+		array_mesh->surface_set_material(0, terrain_material);
+		terrain_mesh->set_mesh(array_mesh);
+		return terrain_mesh;
+	}
 
-		float minx = FLT_MAX;
-		float minz = FLT_MAX;
-		float maxx = FLT_MIN;
-		float maxz = FLT_MIN;
+	Ref<ShaderMaterial> import_terrain_material(const Terrain *terrain, const String &scene_dir, const String &asset_dir) {
+		// Blend Maps, blend_map_layers weights per texel
+		uint32_t blend_map_dim = 0;
+		uint32_t blend_map_layers = 0;
+		TList<uint8_t> blend_map_buffer = Terrain_GetBlendMapT(terrain, &blend_map_dim, &blend_map_layers);
 
-		for (uint32_t i = 0; i < vertex_buffer.size(); ++ i) {
-			const LibSWBF2::Vector3 &zzz = *vertex_buffer.at(i);
-			vertex.push_back(Vector3(zzz.m_X, zzz.m_Y, zzz.m_Z));
-			minx = MIN(minx, zzz.m_X);
-			minz = MIN(minz, zzz.m_Z);
-			maxx = MAX(maxx, zzz.m_X);
-			maxz = MAX(maxz, zzz.m_Z);
+		// Blend Layers
+		// TODO: Does SWBF2 have terrain bump mapping?
+		TList<const LibSWBF2::Texture> layer_textures = Terrain_GetLayerTexturesT(terrain, container);
+		std::vector<Ref<ImageTexture>> layers;
+		for (size_t i = 0; i < layer_textures.size(); ++ i) {
+			const LibSWBF2::Texture *texture = layer_textures.at(i);
+			if (texture) {
+				layers.push_back(import_texture(texture, api_str_to_godot(Texture_GetName, texture), TextureUsage::Albedo, asset_dir));
+			} else {
+				LOG_ERROR(logger, "Failed to find terrain layer image ", (int64_t)i);
+				layers.push_back(Ref<ImageTexture>());
+			}
 		}
 
-		for (uint32_t i = 0; i < vertex_buffer.size(); ++ i) {
-			const LibSWBF2::Vector3 &zzz = *vertex_buffer.at(i);
-			blend_uv.push_back(Vector2((zzz.m_X - minx) / (maxx - minx), (zzz.m_Z - minz) / (maxz - minz)));
-		}
+		return create_terrain_material(blend_map_buffer.data(), blend_map_dim, blend_map_layers, layers, scene_dir);
+	}
 
-		for (uint32_t i = 0; i < tex_uv_buffer.size(); ++ i) {
-			const LibSWBF2::Vector2 &zzz = *tex_uv_buffer.at(i);
-			tex_uv.push_back(Vector2(zzz.m_X, zzz.m_Y));
+	// Packs the blend map into the sparse maps sampled by the terrain
+	// shader and the layer textures into one array, see terrain_blend.hpp
+	Ref<ShaderMaterial> create_terrain_material(const uint8_t *blend_map, uint32_t blend_map_dim, uint32_t blend_map_layers,
+	                                            const std::vector<Ref<ImageTexture>> &layers, const String &scene_dir) {
+		ScopedPhase phase(report, "terrain_material");
+
+		Ref<Shader> shader;
+		shader.instantiate();
+		shader->set_code(TERRAIN_SHADER_CODE);
+		if (Error save_err = save_resource(shader, scene_dir + String("/terrain.gdshader"))) {
+			LOG_ERROR(logger, "Error saving terrain shader ", save_err);
 		}
 
+		Ref<ShaderMaterial> terrain_material;
+		terrain_material.instantiate();
+		terrain_material->set_shader(shader);
+
+		TerrainBlendMaps blend_maps;
+		build_terrain_blend_maps(blend_map, blend_map_dim, blend_map_layers, pool, blend_maps);
+		String layer_index_path = scene_dir + String("/terrain_layer_index.png");
+		String layer_weight_path = scene_dir + String("/terrain_layer_weight.png");
+		will_write(layer_index_path);
+		will_write(layer_weight_path);
+		if (blend_maps.layer_index->save_png(layer_index_path) == Error::OK) {
+			report.add_file_written(layer_index_path);
+		}
+		if (blend_maps.layer_weight->save_png(layer_weight_path) == Error::OK) {
+			report.add_file_written(layer_weight_path);
+		}
+		terrain_material->set_shader_parameter("LayerIndex", ImageTexture::create_from_image(blend_maps.layer_index));
+		terrain_material->set_shader_parameter("LayerWeight", ImageTexture::create_from_image(blend_maps.layer_weight));
 
-		// Calculate normals because what comes out of LibSWBF2 is junk
-		normal.resize(vertex_buffer.size());
-		normal.fill(Vector3());
-
-		// Yeah... If we don't do this we can't calculate normals
-		// correctly. I know it's bad, you know it's bad, let's just move on.
-		printdebug("Brute force optimizing terrain indices... This will take a minute");
-		PackedByteArray visited;
-		visited.resize(index_buffer.size());
-		visited.fill(0);
-
-		bool index_errors = false;
-
-		int dbg_last_pct = -1;
-		for (uint32_t i = 0; i < index_buffer.size(); ++ i) {
-			int pct = std::floor(static_cast<float>(i) / index_buffer.size() * 100);
-			if (pct > dbg_last_pct) {
-				dbg_last_pct = pct;
-				printdebug(pct, "%");
-			}
-			size_t ii = *index_buffer.at(i);
-			if (ii >= vertex.size()) {
-				if (!index_errors) {
-					UtilityFunctions::printerr("Terrain index ", ii, " is beyond the size of this vertex array (", vertex.size(), ") and skipping further index errors");
-				}
-				index_errors = true;
-				continue;
-			}
-			const Vector3 &iii = vertex[ii];
-			if (visited[i] == 0) {
-				for (uint32_t j = i + 1; j < index_buffer.size(); ++ j) {
-					size_t ij = *index_buffer.at(j);
-					if (ij >= vertex.size()) {
-						if (!index_errors) {
-							UtilityFunctions::printerr("Terrain index ", ij, " is beyond the size of this vertex array (", vertex.size(), ") and skipping further index errors");
-						}
-						index_errors = true;
-						continue;
-					}
-					const Vector3 &jjj = vertex[ij];
-					if (iii.distance_squared_to(jjj) < 0.01) {
-						*index_buffer.at(j) = *index_buffer.at(i);
-						visited[j] = 1;
-					}
-				}
+		std::vector<Ref<Image>> layer_images;
+		for (size_t i = 0; i < layers.size() && i < TERRAIN_MAX_LAYERS; ++ i) {
+			layer_images.push_back(layers[i].is_valid() ? layers[i]->get_image() : Ref<Image>());
+		}
+		Ref<Texture2DArray> layer_array = build_terrain_layer_array(layer_images, options.texture_compression);
+		if (layer_array.is_valid()) {
+			String layer_array_path = scene_dir + String("/terrain_layers") + options.get_resource_extension();
+			if (Error save_err = save_resource(layer_array, layer_array_path)) {
+				LOG_ERROR(logger, "Error saving terrain layers ", save_err);
 			}
+			terrain_material->set_shader_parameter("Layers", layer_array);
+		} else {
+			LOG_ERROR(logger, "Terrain has no layer textures");
 		}
 
-		// Note the reversed index orders
-		for (uint32_t i = 0; i < index_buffer.size() - 2; i += 3) {
-			int v0 = *index_buffer.at(i+2);
-			int v1 = *index_buffer.at(i+1);
-			int v2 = *index_buffer.at(i+0);
+		return terrain_material;
+	}
 
-			int max_v = std::max(v0, std::max(v1, v2));
+	Node3D *import_terrain(const World *world, const String &scene_dir, const String &asset_dir) {
+		const Terrain *terrain = World_GetTerrain(world);
+		if (terrain == nullptr) {
+			return nullptr;
+		}
 
-			if (max_v >= vertex.size()) {
-				if (!index_errors) {
-					UtilityFunctions::printerr("Terrain index ", max_v, " is beyond the size of this vertex array (", vertex.size(), ") and skipping further index errors");
-				}
-				index_errors = true;
-				continue;
-			}
+		String terrain_name = api_str_to_godot(World_GetTerrainName, world);
+		ScopedAsset asset(report, "terrain", terrain_name);
 
-			index.push_back(v0);
-			index.push_back(v1);
-			index.push_back(v2);
+		TList<uint32_t> index_buffer = Terrain_GetIndexBufferT(terrain);
+		TList<const LibSWBF2::Vector3> vertex_buffer = Terrain_GetVertexBufferT(terrain);
+		TList<const LibSWBF2::Vector2> tex_uv_buffer = Terrain_GetUVBufferT(terrain);
 
-			Vector3 n0 = vertex[v1] - vertex[v0];
-			Vector3 n1 = vertex[v2] - vertex[v0];
-			Vector3 fn = n0.cross(n1).normalized();
-			normal[v0] -= fn;
-			normal[v1] -= fn;
-			normal[v2] -= fn;
+		// Calculate normals because what comes out of LibSWBF2 is junk
+		LOG_INFO(logger, "Building terrain mesh on ", pool.get_thread_count(), " threads");
+		TerrainMesh mesh;
+		{
+			ScopedPhase phase(report, "terrain_mesh");
+			build_terrain_mesh(vertex_buffer.data(), vertex_buffer.size(),
+			                   tex_uv_buffer.data(), tex_uv_buffer.size(),
+			                   index_buffer.data(), index_buffer.size(),
+			                   pool, mesh);
 		}
-
-		for (uint32_t i = 0; i < normal.size(); ++ i) {
-			normal[i].normalize();
+		if (mesh.index_errors) {
+			LOG_ERROR(logger, "Terrain index ", mesh.first_bad_index, " is beyond the size of this vertex array (", mesh.vertex.size(), ") and skipping further index errors");
 		}
+		LOG_INFO(logger, "Welded ", mesh.weld.merged_vertices, " terrain vertices (", mesh.weld.remapped_indices, " indices)");
 
-		mesh_data[Mesh::ArrayType::ARRAY_VERTEX] = vertex;
-		mesh_data[Mesh::ArrayType::ARRAY_NORMAL] = normal;
-		mesh_data[Mesh::ArrayType::ARRAY_TEX_UV] = tex_uv;
-		mesh_data[Mesh::ArrayType::ARRAY_TEX_UV2] = blend_uv;
-		mesh_data[Mesh::ArrayType::ARRAY_INDEX] = index;
-
-		array_mesh->add_surface_from_arrays(Mesh::PrimitiveType::PRIMITIVE_TRIANGLES, mesh_data);
+		// Every chunk shares the one terrain material
+		Ref<ShaderMaterial> terrain_material = import_terrain_material(terrain, scene_dir, asset_dir);
+		return create_terrain(mesh, terrain_name, terrain_material, scene_dir);
+	}
 
-		// Create the terrain material
-		Ref<ShaderMaterial> terrain_material;
-		terrain_material.instantiate();
-		terrain_material->set_shader(ResourceLoader::get_singleton()->load("res://terrain_shader.gdshader"));
+	// Builds the terrain's mesh instances, or chunks of them, and saves them
+	// as the terrain scene. Returns an instance of the saved scene.
+	Node3D *create_terrain(const TerrainMesh &mesh, const String &terrain_name, const Ref<ShaderMaterial> &terrain_material, const String &scene_dir) {
+		Node3D *terrain_root = nullptr;
+		if (options.terrain_chunks > 1) {
+			// Split the terrain so Godot can frustum cull and LOD each chunk
+			std::vector<TerrainChunk> chunks;
+			{
+				ScopedPhase phase(report, "terrain_chunks");
+				split_terrain_mesh(mesh, options.terrain_chunks, options.terrain_lod_levels, pool, chunks);
+			}
+			LOG_INFO(logger, "Split terrain into ", (int64_t)chunks.size(), " chunks");
 
-		// Blend Maps
-		uint32_t blend_map_dim = 0;
-		uint32_t blend_map_layers = 0; // Do we care? Right now I ignore layers
-		TList<uint8_t> blend_map_buffer = Terrain_GetBlendMapT(terrain, &blend_map_dim, &blend_map_layers);
+			terrain_root = memnew(Node3D);
+			if (terrain_root == nullptr) {
+				LOG_ERROR(logger, "Failed to create terrain node");
+				return nullptr;
+			}
+			terrain_root->set_name(make_name_valid(terrain_name));
 
-		for (int i = 0; i < 4; ++ i) {
-			PackedByteArray packed_buffer;
-			size_t size = blend_map_dim * blend_map_dim * sizeof(*blend_map_buffer.at(0)) * 4;
-			packed_buffer.resize(size);
-			uint8_t *ptrw = packed_buffer.ptrw();
-			for (int h = 0; h < blend_map_dim; ++ h) {
-			for (int w = 0; w < blend_map_dim; ++ w) {
-				// Wtf is this indexing scheme???
-				for (int j = 0; j < 4; ++ j) {
-					if (i * 4 + j >= blend_map_layers) {
-						continue;
-					}
-					ptrw[(blend_map_dim * h + w) * 4 + j] = *blend_map_buffer.at(blend_map_layers * (blend_map_dim * h + w) + i * 4 + j);
+			for (const TerrainChunk &chunk : chunks) {
+				Dictionary lods;
+				for (const TerrainChunkLOD &lod : chunk.lods) {
+					lods[lod.edge_length] = lod.index;
 				}
-			}}
-
-			Ref<Image> image = Image::create_from_data(blend_map_dim, blend_map_dim, false, Image::Format::FORMAT_RGBA8, packed_buffer);
-			image->save_png(scene_dir + String("/") + String("terrain_blend_map_") + itos(i) + String(".png"));
-			terrain_material->set_shader_parameter("BlendMap" + itos(i), ImageTexture::create_from_image(image));
+				MeshInstance3D *chunk_mesh = create_terrain_mesh_instance(chunk.vertex, chunk.normal, chunk.tex_uv, chunk.blend_uv, chunk.index, lods, terrain_material);
+				if (chunk_mesh == nullptr) {
+					continue;
+				}
+				chunk_mesh->set_name("chunk_" + itos(chunk.x) + "_" + itos(chunk.z));
+				make_parent_and_owner(terrain_root, chunk_mesh);
+			}
+		} else {
+			terrain_root = create_terrain_mesh_instance(mesh.vertex, mesh.normal, mesh.tex_uv, mesh.blend_uv, mesh.index, Dictionary(), terrain_material);
+			if (terrain_root == nullptr) {
+				return nullptr;
+			}
+			terrain_root->set_name(make_name_valid(terrain_name));
 		}
 
-		// Blend Layers
-		// TODO: Does SWBF2 have terrain bump mapping?
-		TList<const LibSWBF2::Texture> layer_textures = Terrain_GetLayerTexturesT(terrain, container);
-		for (size_t i = 0; i < layer_textures.size(); ++ i) {
-			const LibSWBF2::Texture *texture = layer_textures.at(i);
-			if (texture) {
-				Ref<ImageTexture> albedo_texture = import_texture(texture, scene_dir);
-				terrain_material->set_shader_parameter("BlendLayer" + itos(i), albedo_texture);
-			} else {
-				UtilityFunctions::printerr("Failed to find terrain layer image ", api_str_to_godot(Texture_GetName, texture));
+		if (options.terrain_collision) {
+			if (StaticBody3D *collision = create_terrain_collision(mesh, terrain_name)) {
+				make_parent_and_owner(terrain_root, collision);
 			}
 		}
 
-		array_mesh->surface_set_material(0, terrain_material);
-		terrain_mesh->set_mesh(array_mesh);
+		String scene_path = scene_dir + String("/") + String(terrain_name) + String("_terrain") + options.get_scene_extension();
 
-		String scene_path = scene_dir + String("/") + String(terrain_name) + String("_terrain.tscn");
-
-		Error save_err = save_as_scene(terrain_mesh, scene_path);
+		Ref<PackedScene> scene;
+		Error save_err = save_as_scene(terrain_root, scene_path, scene);
 		if (save_err == Error::OK) {
-			Ref<PackedScene> scene = ResourceLoader::get_singleton()->load(scene_path);
 			if (scene->can_instantiate()) {
-				memdelete(terrain_mesh);
-				terrain_mesh = Node::cast_to<MeshInstance3D>(scene->instantiate());
-				if (terrain_mesh == nullptr) {
-					UtilityFunctions::printerr("Terrain scene instantiation failed");
+				memdelete(terrain_root);
+				terrain_root = Node::cast_to<Node3D>(scene->instantiate());
+				if (terrain_root == nullptr) {
+					LOG_ERROR(logger, "Terrain scene instantiation failed");
 					return nullptr;
 				}
 			} else {
-				UtilityFunctions::printerr("Terrain scene cannot be instantiated");
+				LOG_ERROR(logger, "Terrain scene cannot be instantiated");
 			}
 		}
 
-		return terrain_mesh;
+		return terrain_root;
+	}
+
+	// Resamples the terrain onto a regular grid and builds a StaticBody3D
+	// with a HeightMapShape3D per collision tile, which is far cheaper to
+	// store and collide with than a ConcavePolygonShape3D of every triangle
+	StaticBody3D *create_terrain_collision(const TerrainMesh &mesh, const String &terrain_name) {
+		ScopedPhase phase(report, "terrain_collision");
+		float spacing = options.terrain_collision_spacing > 0.0f ? options.terrain_collision_spacing : estimate_terrain_spacing(mesh);
+		TerrainHeightGrid grid;
+		build_terrain_height_grid(mesh, spacing, pool, grid);
+		if (grid.width < 2 || grid.depth < 2) {
+			LOG_ERROR(logger, "Terrain ", terrain_name, " is too small for height map collision");
+			return nullptr;
+		}
+		// Every tile needs at least one quad each way
+		uint32_t tiles = MIN(options.terrain_collision_tiles, MIN(grid.width - 1, grid.depth - 1));
+		LOG_INFO(logger, "Terrain collision is ", grid.width, " x ", grid.depth, " points ", spacing, " apart in ", tiles * tiles, " tiles");
+
+		StaticBody3D *static_body = memnew(StaticBody3D);
+		if (static_body == nullptr) {
+			LOG_ERROR(logger, "memnew failed to allocate a StaticBody3D");
+			return nullptr;
+		}
+		static_body->set_name(make_name_valid(terrain_name + "_collision"));
+
+		for (uint32_t tile_z = 0; tile_z < tiles; ++ tile_z) {
+			for (uint32_t tile_x = 0; tile_x < tiles; ++ tile_x) {
+				uint32_t x0, z0, width, depth;
+				PackedFloat32Array height;
+				get_height_grid_tile(grid, tiles, tile_x, tile_z, x0, z0, width, depth, height);
+
+				// Height map points are always one unit apart, so the shape is
+				// scaled up to the grid spacing and its heights scaled down
+				float *h = height.ptrw();
+				for (int64_t i = 0; i < height.size(); ++ i) {
+					h[i] /= spacing;
+				}
+				Ref<HeightMapShape3D> shape;
+				shape.instantiate();
+				shape->set_map_width(width);
+				shape->set_map_depth(depth);
+				shape->set_map_data(height);
+
+				CollisionShape3D *collision_shape = memnew(CollisionShape3D);
+				if (collision_shape == nullptr) {
+					LOG_ERROR(logger, "memnew failed to allocate a CollisionShape3D");
+					continue;
+				}
+				collision_shape->set_name("tile_" + itos(tile_x) + "_" + itos(tile_z));
+				collision_shape->set_shape(shape);
+				// The shape is centred on its node
+				collision_shape->set_position(Vector3(grid.min_x + (x0 + (width - 1) * 0.5f) * spacing, 0.0f,
+				                                      grid.min_z + (z0 + (depth - 1) * 0.5f) * spacing));
+				collision_shape->set_scale(Vector3(spacing, spacing, spacing));
+				make_parent_and_owner(static_body, collision_shape);
+			}
+		}
+		return static_body;
 	}
 
 	Ref<ImageTexture> maybe_load_texture(const String &image_name) {
@@ -382,47 +867,204 @@ class WorldImporter {
 		return Ref<ImageTexture>{};
 	}
 
-	Ref<ImageTexture> import_texture(const LibSWBF2::Texture *texture, const String &scene_dir) {
-		uint16_t width = 0;
-		uint16_t height = 0;
+	TextureJob make_texture_job(const LibSWBF2::Texture *texture, const String &texture_name, TextureUsage usage, const String &asset_dir) {
+		TextureJob job;
+		job.texture = texture;
+		job.name = texture_name;
+		job.png_path = asset_dir + String("/") + String(texture_name) + String("_tex.png");
+		job.usage = usage;
+		job.compression = options.texture_compression;
+		if (texture == nullptr && synthetic) {
+			if (const SyntheticTexture *synthetic_texture = synthetic->find_texture(texture_name)) {
+				job.pixels = synthetic_texture->pixels;
+				job.width = synthetic_texture->resolution;
+				job.height = synthetic_texture->resolution;
+			}
+		}
+		if (job.compression == TextureCompression::None) {
+			// Workers write the PNG while decoding, so a cancelled import
+			// may leave it behind without ever reaching finish_texture
+			will_write(job.png_path);
+		}
+		if (options.use_cache) {
+			job.has_cached_hash = cache.lookup("texture:" + texture_name, job.cached_hash);
+		}
+		return job;
+	}
 
-		TList<uint8_t> buffer = Texture_GetDataT(texture, &width, &height);
+	static TextureUsage texture_usage(const MaterialView &material, int slot) {
+		// I'm assuming this matches the order of textures used by XSI, see import_material
+		if (slot == 1) {
+			return TextureUsage::NormalMap;
+		}
+		if ((uint32_t)material.flags & (uint32_t)EMaterialFlags::Transparent) {
+			return TextureUsage::TransparentAlbedo;
+		}
+		return TextureUsage::Albedo;
+	}
 
-		if (width == 0 || height == 0) {
-			UtilityFunctions::printerr("Failed to load SWBF2 texture");
+	Ref<ImageTexture> finish_texture(const TextureJob &job, const String &asset_dir) {
+		String cache_key = "texture:" + job.name;
+		if (job.up_to_date) {
+			Ref<ImageTexture> cached = load_resource(cache.get_path(cache_key));
+			if (cached.is_valid()) {
+				LOG_TRACE(logger, "Texture ", job.name, " is unchanged");
+				report.add_count("cached_textures");
+				textures.insert(job.name, cached);
+				return cached;
+			}
+			LOG_ERROR(logger, "Failed to load cached texture ", job.name, "; re-importing");
+			TextureJob fresh = job;
+			fresh.has_cached_hash = false;
+			fresh.up_to_date = false;
+			decode_texture(fresh);
+			return finish_texture(fresh, asset_dir);
+		}
+		if (!job.image.is_valid()) {
+			LOG_ERROR(logger, "Failed to load SWBF2 texture ", job.name);
 			return {};
 		}
+		// Decoding ran single threaded on a worker, so its wall time is
+		// also its CPU time
+		uint64_t start_wall_usec = ImportReport::wall_usec();
+		uint64_t start_cpu_usec = ImportReport::cpu_usec();
+		report.add_count("textures");
+		if (job.png_error) {
+			LOG_ERROR(logger, "Error saving texture image ", job.png_path, " ", job.png_error);
+		} else if (job.compression == TextureCompression::None) {
+			report.add_file_written(job.png_path);
+		}
+		if (job.compress_error) {
+			LOG_ERROR(logger, "Error compressing texture ", job.name, " ", job.compress_error, "; saving it uncompressed");
+		}
 
-		String texture_name = api_str_to_godot(Texture_GetName, texture);
+		String resource_path = asset_dir + String("/") + String(job.name) + String("_tex") + options.get_resource_extension();
 
-		String png_path = scene_dir + String("/") + String(texture_name) + String("_tex.png");
-		String resource_path = scene_dir + String("/") + String(texture_name) + String("_tex.tres");
+		Ref<ImageTexture> texture2d = ImageTexture::create_from_image(job.image);
+		if (Error save_err = save_resource(texture2d, resource_path)) {
+			LOG_ERROR(logger, "Error saving texture ", save_err);
+		} else {
+			textures.insert(job.name, texture2d);
+			cache.record(cache_key, job.content_hash, resource_path);
+		}
+		report.add_asset("texture", job.name,
+		                 job.decode_usec + ImportReport::wall_usec() - start_wall_usec,
+		                 job.decode_usec + ImportReport::cpu_usec() - start_cpu_usec);
+		return texture2d;
+	}
 
+	Ref<ImageTexture> import_texture(const LibSWBF2::Texture *texture, const String &texture_name, TextureUsage usage, const String &asset_dir) {
+		// Textures are normally imported up front by import_world_textures
 		Ref<ImageTexture> texture2d = maybe_load_texture(texture_name);
 		if (!texture2d.is_valid()) {
-			printdebug("Importing texture ", texture_name);
-
-			PackedByteArray packed_buffer;
-			size_t size = width * height * sizeof(*buffer.at(0)) * 4;
-			packed_buffer.resize(size);
-			memcpy(packed_buffer.ptrw(), buffer.data(), size);
-
-			Ref<Image> image = Image::create_from_data(width, height, false, Image::Format::FORMAT_RGBA8, packed_buffer);
-			image->save_png(png_path);
-			texture2d = ImageTexture::create_from_image(image);
-			if (Error save_err = ResourceSaver::get_singleton()->save(texture2d, resource_path)) {
-				UtilityFunctions::printerr("Error saving texture ", save_err);
-			} else {
-				// This seems unnecessary, but if we don't re-load the resource
-				// it won't be referenced by anything that uses this Ref<ImageTexture>
-				texture2d = ResourceLoader::get_singleton()->load(resource_path);
-				textures.insert(texture_name, texture2d);
-			}
+			LOG_TRACE(logger, "Importing texture ", texture_name);
+			TextureJob job = make_texture_job(texture, texture_name, usage, asset_dir);
+			decode_texture(job);
+			texture2d = finish_texture(job, asset_dir);
 		}
 
 		return texture2d;
 	}
 
+	// Textures without a name are missing and skipped
+	void collect_texture(const LibSWBF2::Texture *texture, const String &texture_name, TextureUsage usage, HashMap<String, size_t> &seen, std::vector<TextureJob> &jobs, const String &asset_dir) {
+		if (texture_name.is_empty() || textures.has(texture_name)) {
+			return;
+		}
+		if (const size_t *job_index = seen.getptr(texture_name)) {
+			// Textures used as both albedo and normal map are compressed as
+			// albedo, and any transparent use keeps the alpha channel
+			TextureJob &job = jobs[*job_index];
+			if (job.usage == TextureUsage::NormalMap || usage == TextureUsage::TransparentAlbedo) {
+				job.usage = usage;
+			}
+			return;
+		}
+		seen.insert(texture_name, jobs.size());
+		jobs.push_back(make_texture_job(texture, texture_name, usage, asset_dir));
+	}
+
+	void collect_model_textures(const String &model_name, HashMap<String, size_t> &seen, std::vector<TextureJob> &jobs, const String &asset_dir) {
+		read_model(model_name, [&](const ModelView &model) {
+			for (const SegmentView &segment : model.segments) {
+				const MaterialView &material = segment.material;
+				// Albedo and normal map, see import_material
+				for (int slot = 0; slot < 2; ++ slot) {
+					collect_texture(material.texture[slot], material.texture_name[slot], texture_usage(material, slot), seen, jobs, asset_dir);
+				}
+			}
+		});
+	}
+
+	void collect_entity_class_textures(const String &entity_class_name, HashSet<String> &seen_classes, HashMap<String, size_t> &seen, std::vector<TextureJob> &jobs, const String &asset_dir) {
+		if (seen_classes.has(entity_class_name) || entity_class_scenes.has(entity_class_name)) {
+			return;
+		}
+		seen_classes.insert(entity_class_name);
+		EntityClassView entity_class;
+		if (!read_entity_class(entity_class_name, entity_class)) {
+			return;
+		}
+		for (const std::pair<uint32_t, String> &property : entity_class.properties) {
+			switch (property.first) {
+				case fnv_hash("GeometryName"):
+					collect_model_textures(property.second, seen, jobs, asset_dir);
+					break;
+				case fnv_hash("AttachODF"):
+					collect_entity_class_textures(property.second, seen_classes, seen, jobs, asset_dir);
+					break;
+				default:
+					break;
+			}
+		}
+	}
+
+	void collect_instance_textures(const std::vector<InstanceView> &instances, HashMap<String, size_t> &seen, std::vector<TextureJob> &jobs, const String &asset_dir) {
+		HashSet<String> seen_classes;
+		for (const InstanceView &instance : instances) {
+			collect_entity_class_textures(instance.entity_class_name, seen_classes, seen, jobs, asset_dir);
+		}
+	}
+
+	// Decode and PNG encode every texture the world references on the
+	// worker pool before we start building scenes, which then only ever
+	// find textures already imported.
+	void import_world_textures(const World *world, const std::vector<InstanceView> &instances, const String &asset_dir) {
+		HashMap<String, size_t> seen;
+		std::vector<TextureJob> jobs;
+
+		collect_instance_textures(instances, seen, jobs, asset_dir);
+		if (const Terrain *terrain = World_GetTerrain(world)) {
+			TList<const LibSWBF2::Texture> layer_textures = Terrain_GetLayerTexturesT(terrain, container);
+			for (size_t i = 0; i < layer_textures.size(); ++ i) {
+				if (const LibSWBF2::Texture *texture = layer_textures.at(i)) {
+					collect_texture(texture, api_str_to_godot(Texture_GetName, texture), TextureUsage::Albedo, seen, jobs, asset_dir);
+				}
+			}
+		}
+		if (const Config *skydome_config = find_skydome_config(world)) {
+			for (const String &model_name : get_skydome_model_names(skydome_config)) {
+				collect_model_textures(model_name, seen, jobs, asset_dir);
+			}
+		}
+		import_textures(jobs, asset_dir);
+	}
+
+	void import_textures(std::vector<TextureJob> &jobs, const String &asset_dir) {
+		LOG_INFO(logger, "Importing ", (int64_t)jobs.size(), " textures on ", pool.get_thread_count(), " threads");
+		{
+			ScopedPhase phase(report, "texture_decode");
+			decode_textures(jobs, pool);
+		}
+		for (size_t i = 0; i < jobs.size(); ++ i) {
+			if (is_cancelled()) {
+				return;
+			}
+			set_progress("world_textures", i, jobs.size());
+			finish_texture(jobs[i], asset_dir);
+		}
+	}
+
 	Ref<StandardMaterial3D> maybe_load_material(const String &albedo_texture_name) {
 		if (materials.has(albedo_texture_name)) {
 			return materials.get(albedo_texture_name);
@@ -430,24 +1072,44 @@ class WorldImporter {
 		return Ref<StandardMaterial3D>{};
 	}
 
-	Ref<StandardMaterial3D> import_material(const LibSWBF2::Material *material, const String &scene_dir) {
+	Ref<StandardMaterial3D> import_material(const MaterialView &material, const String &asset_dir) {
 		// All material types have an albedo texture
 		// TODO: We assume all materials which share an albedo texture are the same material. This is probably the case?
-		const LibSWBF2::Texture *texture = Material_GetTexture(material, 0);
-		if (!texture) {
-			UtilityFunctions::printerr("Failed to get albedo map texture for material");
+		const String &albedo_texture_name = material.texture_name[0];
+		if (albedo_texture_name.is_empty()) {
+			LOG_ERROR(logger, "Failed to get albedo map texture for material");
 			return Ref<StandardMaterial3D>{};
 		}
 
-		String albedo_texture_name = api_str_to_godot(Texture_GetName, texture);
-		String resource_path = scene_dir + String("/") + albedo_texture_name + String("_mat.tres");
+		String resource_path = asset_dir + String("/") + albedo_texture_name + String("_mat") + options.get_resource_extension();
 
 		Ref<StandardMaterial3D> standard_material = maybe_load_material(albedo_texture_name);
 
+		// Materials only reference their textures by path, so they're
+		// unchanged as long as their texture names and flags are
+		String cache_key = "material:" + albedo_texture_name;
+		ContentHasher material_hasher;
+		material_hasher.add(albedo_texture_name);
+		if (!material.texture_name[1].is_empty()) {
+			material_hasher.add(material.texture_name[1]);
+		}
+		material_hasher.add(material.flags);
+		uint64_t material_hash = material_hasher.get();
+
+		if (!standard_material.is_valid() && options.use_cache && cache.is_fresh(cache_key, material_hash)) {
+			standard_material = load_resource(resource_path);
+			if (standard_material.is_valid()) {
+				report.add_count("cached_materials");
+				materials.insert(albedo_texture_name, standard_material);
+			}
+		}
+
 		if (!standard_material.is_valid()) {
+			ScopedAsset asset(report, "material", albedo_texture_name);
+			report.add_count("materials");
 			standard_material.instantiate();
 
-			Ref<ImageTexture> albedo_texture = import_texture(texture, scene_dir);
+			Ref<ImageTexture> albedo_texture = import_texture(material.texture[0], albedo_texture_name, texture_usage(material, 0), asset_dir);
 			standard_material->set_texture(BaseMaterial3D::TextureParam::TEXTURE_ALBEDO, albedo_texture);
 
 			// TODO: Other textures? Specular?
@@ -455,13 +1117,13 @@ class WorldImporter {
 			// https://sites.google.com/site/swbf2modtoolsdocumentation/misc_documentation
 			// I am not confident LibSWBF2 correctly sets the BumpMap flag, so attempt to load
 			// the second image of every material as normal map image.
-			EMaterialFlags material_flags = Material_GetFlags(material);
+			EMaterialFlags material_flags = material.flags;
 			//if ((uint32_t)material_flags & (uint32_t)EMaterialFlags::BumpMap) {
-				if (const LibSWBF2::Texture *texture = Material_GetTexture(material, 1)) {
-					Ref<ImageTexture> normal_texture = import_texture(texture, scene_dir);
+				if (!material.texture_name[1].is_empty()) {
+					Ref<ImageTexture> normal_texture = import_texture(material.texture[1], material.texture_name[1], texture_usage(material, 1), asset_dir);
 					standard_material->set_texture(BaseMaterial3D::TextureParam::TEXTURE_NORMAL, normal_texture);
 				} else if ((uint32_t)material_flags & (uint32_t)EMaterialFlags::BumpMap) {
-					UtilityFunctions::printerr("Failed to get normal map texture for material");
+					LOG_ERROR(logger, "Failed to get normal map texture for material");
 				}
 			//}
 
@@ -473,365 +1135,531 @@ class WorldImporter {
 			standard_material->set_specular(0);
 			standard_material->set_metallic(0);
 
-			if (Error save_err = ResourceSaver::get_singleton()->save(standard_material, resource_path)) {
-				UtilityFunctions::printerr("Error saving material ", save_err);
+			if (Error save_err = save_resource(standard_material, resource_path)) {
+				LOG_ERROR(logger, "Error saving material ", save_err);
 			} else {
-				// This seems unnecessary, but if we don't re-load the resource
-				// it won't be referenced by anything that uses this Ref<StandardMaterial>
-				standard_material = ResourceLoader::get_singleton()->load(resource_path);
 				materials.insert(albedo_texture_name, standard_material);
+				cache.record(cache_key, material_hash, resource_path);
+			}
+		}
+
+		return standard_material;
+	}
+
+	// False if any normal is zero length or not finite
+	static bool normals_valid(const PackedVector3Array &normal) {
+		const Vector3 *n = normal.ptr();
+		for (int64_t i = 0; i < normal.size(); ++ i) {
+			if (!std::isfinite(n[i].x) || !std::isfinite(n[i].y) || !std::isfinite(n[i].z) || n[i].length_squared() == 0) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+	// Fills mesh_data with the surface arrays of a segment. False if the
+	// segment should be skipped.
+	bool segment_to_arrays(const SegmentBuffers &segment, const String &mesh_name, Array &mesh_data) {
+		mesh_data.resize(Mesh::ArrayType::ARRAY_MAX);
+
+		PackedVector3Array vertex;
+		PackedVector3Array normal;
+		PackedVector2Array tex_uv;
+		PackedInt32Array index;
+
+		if (segment.vertex_count != segment.tex_uv_count) {
+			LOG_ERROR(logger, "Skipping mesh with invalid vertex, tex_uv count: ", segment.vertex_count, " ", segment.tex_uv_count);
+			return false;
+		}
+
+		copy_to_packed(segment.vertex, segment.vertex_count, vertex);
+		copy_to_packed(segment.tex_uv, segment.tex_uv_count, tex_uv);
+
+		// Missing or broken normals are regenerated once we have triangles
+		bool generate_normals = segment.normal_count != segment.vertex_count;
+		if (!generate_normals) {
+			copy_to_packed(segment.normal, segment.normal_count, normal);
+			generate_normals = !normals_valid(normal);
+		}
+
+		if (segment.topology == ETopology::PointList ||
+		    segment.topology == ETopology::LineList ||
+		    segment.topology == ETopology::LineStrip)
+		{
+			LOG_ERROR(logger, "Skipping mesh segment with unsupported topology");
+			return false;
+		} else if (segment.topology == ETopology::TriangleList) {
+			widen_to_packed(segment.index, segment.index_count, index);
+		} else if (segment.topology == ETopology::TriangleStrip) {
+			index = decode_triangle_strips(segment.index, segment.index_count);
+		} else if (segment.topology == ETopology::TriangleFan) {
+			if (segment.index_count < 3) {
+				LOG_ERROR(logger, "Skipping mesh segment triangle fan with only ", segment.index_count, " indices");
+				return false;
+			}
+			// Convert fan to list
+			const uint16_t *fan = segment.index;
+			uint16_t hub = fan[0];
+			index.resize(((segment.index_count - 1) / 2) * 3);
+			int32_t *out = index.ptrw();
+			for (uint32_t i = 1; i < segment.index_count - 1; i += 2) {
+				*out++ = hub;
+				*out++ = fan[i+0];
+				*out++ = fan[i+1];
 			}
+		} else {
+			LOG_ERROR(logger, "Skipping mesh segment with unknown topology ", (int32_t)segment.topology);
 		}
 
-		return standard_material;
+		if (generate_normals) {
+			const int32_t *ip = index.ptr();
+			bool index_valid = true;
+			for (int64_t i = 0; i < index.size(); ++ i) {
+				if (ip[i] < 0 || ip[i] >= vertex.size()) {
+					index_valid = false;
+					break;
+				}
+			}
+			if (!index_valid) {
+				LOG_ERROR(logger, "Skipping mesh segment with invalid normals and out of range indices");
+				return false;
+			}
+			LOG_TRACE(logger, "Generating normals for mesh segment with ", segment.normal_count, " normals for ", segment.vertex_count, " vertices");
+			generate_vertex_normals(vertex, index, pool, normal);
+		}
+
+		mesh_data[Mesh::ArrayType::ARRAY_VERTEX] = vertex;
+		mesh_data[Mesh::ArrayType::ARRAY_NORMAL] = normal;
+		mesh_data[Mesh::ArrayType::ARRAY_TEX_UV] = tex_uv;
+		mesh_data[Mesh::ArrayType::ARRAY_INDEX] = index;
+
+		Dictionary no_lods;
+		optimize_surface(mesh_data, no_lods, mesh_name);
+		count_surface(mesh_data);
+		return true;
 	}
 
-	void segments_to_mesh(MeshInstance3D *mesh_instance, const List<const Segment *> &segments, const String &override_texture, const String &scene_dir) {
+	void segments_to_mesh(MeshInstance3D *mesh_instance, const std::vector<const SegmentView *> &segments, const String &override_texture, const String &asset_dir) {
 		Ref<ArrayMesh> array_mesh;
 		array_mesh.instantiate();
 
 		int surface_index = 0;
 
-		for (size_t si = 0; si < segments.size(); ++ si) {
-			const Segment *segment = segments[si];
-
+		for (const SegmentView *segment : segments) {
 			Array mesh_data;
-			mesh_data.resize(Mesh::ArrayType::ARRAY_MAX);
-
-			PackedVector3Array vertex;
-			PackedVector3Array normal;
-			PackedVector2Array tex_uv;
-			PackedInt32Array index;
-
-			TList<uint16_t> index_buffer = Segment_GetIndexBufferT(segment);
-			TList<const LibSWBF2::Vector3> vertex_buffer = Segment_GetVertexBufferT(segment);
-			TList<const LibSWBF2::Vector2> tex_uv_buffer = Segment_GetUVBufferT(segment);
-			TList<const LibSWBF2::Vector3> normal_buffer = Segment_GetNormalBufferT(segment);
-
-			ETopology topology = Segment_GetTopology(segment);
-
-			if (vertex_buffer.size() != normal_buffer.size() || normal_buffer.size() != tex_uv_buffer.size()) {
-				UtilityFunctions::printerr("Skipping mesh with invalid vertex, normal, tex_uv count: ", vertex_buffer.size(), " ", normal_buffer.size(), " ", tex_uv_buffer.size());
+			if (!segment_to_arrays(segment->buffers, mesh_instance->get_name(), mesh_data)) {
 				continue;
 			}
 
-			for (uint32_t i = 0; i < vertex_buffer.size(); ++ i) {
-				const LibSWBF2::Vector3 &zzz = *vertex_buffer.at(i);
-				vertex.push_back(Vector3(zzz.m_X, zzz.m_Y, zzz.m_Z));
-			}
+			array_mesh->add_surface_from_arrays(Mesh::PrimitiveType::PRIMITIVE_TRIANGLES, mesh_data);
 
-			for (uint32_t i = 0; i < normal_buffer.size(); ++ i) {
-				const LibSWBF2::Vector3 &zzz = *normal_buffer.at(i);
-				normal.push_back(Vector3(zzz.m_X, zzz.m_Y, zzz.m_Z));
-			}
-			for (uint32_t i = 0; i < tex_uv_buffer.size(); ++ i) {
-				const LibSWBF2::Vector2 &zzz = *tex_uv_buffer.at(i);
-				tex_uv.push_back(Vector2(zzz.m_X, zzz.m_Y));
-			}
+			array_mesh->surface_set_material(surface_index, import_material(segment->material, asset_dir));
 
-			if (topology == ETopology::PointList ||
-			    topology == ETopology::LineList ||
-			    topology == ETopology::LineStrip)
-			{
-				UtilityFunctions::printerr("Skipping mesh segment with unsupported topology");
-				continue;
-			} else if (topology == ETopology::TriangleList) {
-				for (uint32_t i = 0; i < index_buffer.size(); ++ i) {
-					index.push_back(*index_buffer.at(i));
-				}
-			} else if (topology == ETopology::TriangleStrip) {
-				// Convert strip to list. From Chunks/MSH/STRP.cpp: Two consecutive indices
-				// with the highest bit set indicate the start of a triangle strip.
-				bool clockwise = false;
-				bool insert_degen_tri = false;
-				std::vector<uint16_t> indices;
-
-				for (uint32_t i = 0; i < index_buffer.size(); ++ i) {
-					uint16_t v = *index_buffer.at(i);
-					// If two consecutive indices have their highest bit set we are
-					// starting a new triangle strip.
-					if (i + 1 < index_buffer.size() && (v & *index_buffer.at(i+1)) & 0x8000) {
-						clockwise = false;
-						indices.clear();
-
-						// In order to transition between triangle strips we need two degenerate
-						// triangles which form an invisible line segment between them.
-						if (index.size() >= 3) {
-							insert_degen_tri = true;
-							// Copy the last triangle
-							index.push_back(index[index.size() - 3]);
-							index.push_back(index[index.size() - 3]);
-							index.push_back(index[index.size() - 3]);
-						} else if (index.size() > 0) {
-							UtilityFunctions::printerr("Triangle strip is malformed. Cannot end triangle strip with less than 3 indices.");
-						}
-					}
+			surface_index += 1;
+		}
 
-					indices.push_back(v & 0x7FFF);
-
-					if (indices.size() >= 3) {
-						uint16_t v0 = indices[indices.size() - 3];
-						uint16_t v1 = indices[indices.size() - 2];
-						uint16_t v2 = indices[indices.size() - 1];
-						// See above for why we may execute this twice to create a degen tri.
-						do {
-							if (clockwise) {
-								index.push_back(v0);
-								index.push_back(v1);
-								index.push_back(v2);
-							} else {
-								index.push_back(v0);
-								index.push_back(v2);
-								index.push_back(v1);
-							}
-						} while (std::exchange(insert_degen_tri, false));
-						clockwise = !clockwise;
-					}
-				}
-			} else if (topology == ETopology::TriangleFan) {
-				if (index_buffer.size() < 3) {
-					UtilityFunctions::printerr("Skipping mesh segment triangle fan with only ", index_buffer.size(), " indices");
-				}
-				// Convert fan to list
-				uint16_t hub = *index_buffer.at(0);
-				for (uint32_t i = 1; i < index_buffer.size() - 1; i += 2) {
-					index.push_back(hub);
-					index.push_back(*index_buffer.at(i+0));
-					index.push_back(*index_buffer.at(i+1));
-				}
-			} else {
-				UtilityFunctions::printerr("Skipping mesh segment with unknown topology ", (int32_t)topology);
-			}
+		mesh_instance->set_mesh(array_mesh);
+	}
 
-			mesh_data[Mesh::ArrayType::ARRAY_VERTEX] = vertex;
-			mesh_data[Mesh::ArrayType::ARRAY_NORMAL] = normal;
-			mesh_data[Mesh::ArrayType::ARRAY_TEX_UV] = tex_uv;
-			mesh_data[Mesh::ArrayType::ARRAY_INDEX] = index;
+	// Nodes created under a model root by name. Every node is indexed as it
+	// is created, so lookups don't have to walk the tree with find_child.
+	// The first node given a name keeps it.
+	using NodeIndex = HashMap<String, Node *>;
 
-			array_mesh->add_surface_from_arrays(Mesh::PrimitiveType::PRIMITIVE_TRIANGLES, mesh_data);
+	static void index_node(NodeIndex &node_index, Node *node) {
+		String name = node->get_name();
+		if (!node_index.has(name)) {
+			node_index.insert(name, node);
+		}
+	}
 
-			array_mesh->surface_set_material(surface_index, import_material(Segment_GetMaterial(segment), scene_dir));
+	static Node *find_indexed(const NodeIndex &node_index, const String &name) {
+		if (Node *const *node = node_index.getptr(name)) {
+			return *node;
+		}
+		return nullptr;
+	}
 
-			surface_index += 1;
+	// Transform of node relative to one of its ancestors
+	static Transform3D get_relative_transform(Node *node, const Node *ancestor) {
+		Transform3D transform;
+		for (; node != nullptr && node != ancestor; node = node->get_parent()) {
+			if (Node3D *node3d = Node::cast_to<Node3D>(node)) {
+				transform = node3d->get_transform() * transform;
+			}
 		}
+		return transform;
+	}
 
-		mesh_instance->set_mesh(array_mesh);
+	Ref<Shape3D> create_collision_primitive_shape(const CollisionPrimitiveView &primitive) {
+		switch (primitive.type) {
+			case ECollisionPrimitiveType::Cube: {
+				Ref<BoxShape3D> shape;
+				shape.instantiate();
+				shape->set_size(Vector3(primitive.dims[0] * 2, primitive.dims[1] * 2, primitive.dims[2] * 2));
+				return shape;
+			}
+			case ECollisionPrimitiveType::Cylinder: {
+				Ref<CylinderShape3D> shape;
+				shape.instantiate();
+				shape->set_radius(primitive.dims[0]);
+				shape->set_height(primitive.dims[1]);
+				return shape;
+			}
+			case ECollisionPrimitiveType::Sphere: {
+				Ref<SphereShape3D> shape;
+				shape.instantiate();
+				shape->set_radius(primitive.dims[0]);
+				return shape;
+			}
+			default:
+				LOG_ERROR(logger, "Skipping unsupported collision primitive type ", (int)primitive.type);
+				return Ref<Shape3D>{};
+		}
 	}
 
-	void populate_model(Node3D *root, const String &model_name, const String &override_texture, const String &scene_dir) {
-		printdebug("Populating model ", model_name);
+	void populate_model(Node3D *root, NodeIndex &node_index, const String &model_name, const String &override_texture, const String &asset_dir) {
+		LOG_TRACE(logger, "Populating model ", model_name);
 
-		// Load the SWBF2 Model representation
-		const Model *model = Container_FindModel(container, FNVHashString(model_name.utf8().get_data()));
-		if (model == nullptr) {
-			UtilityFunctions::printerr("Could not find model ", model_name);
-			return;
+		bool found = read_model(model_name, [&](const ModelView &model) {
+			populate_model(root, node_index, model_name, model, override_texture, asset_dir);
+		});
+		if (!found) {
+			LOG_ERROR(logger, "Could not find model ", model_name);
 		}
+	}
 
+	void populate_model(Node3D *root, NodeIndex &node_index, const String &model_name, const ModelView &model, const String &override_texture, const String &asset_dir) {
 		// Convert the SWBF2 skeleton to something we can work with.
 		// Since we do not import animations I've chosen to convert
 		// all bones to Node3D. The original LVLImport does this with
 		// static meshes but handles skinned meshes with real Unity
 		// skeletons
-		TList<const Bone> bones = Model_GetBonesT(model);
-		if (bones.size() > 0) {
+		if (model.bones.size() > 0) {
 			HashMap<String, Node3D *> named_bones;
 			// Create bone nodes
-			for (size_t i = 0; i < bones.size(); ++ i) {
-				String bone_name = api_str_to_godot(Bone_GetName, bones.at(i));
+			for (const BoneView &bone : model.bones) {
+				const String &bone_name = bone.name;
 				Node3D *bone_node = memnew(Node3D);
 				if (bone_node == nullptr) {
-					UtilityFunctions::printerr("Failed to create bone node");
+					LOG_ERROR(logger, "Failed to create bone node");
 					continue;
 				}
 				bone_node->set_name(make_name_valid(bone_name));
 				named_bones.insert(bone_name, bone_node);
 				make_parent_and_owner(root, bone_node);
+				index_node(node_index, bone_node);
 			}
 			// Organize bone hierarchy 
-			for (size_t i = 0; i < bones.size(); ++ i) {
-				const Bone *bone = bones.at(i);
-				String bone_name = api_str_to_godot(Bone_GetName, bone);
-				Node3D *bone_node = named_bones.get(bone_name);
+			for (const BoneView &bone : model.bones) {
+				const String &bone_name = bone.name;
+				Node3D *bone_node = named_bones.has(bone_name) ? named_bones.get(bone_name) : nullptr;
 				if (bone_node == nullptr) {
-					UtilityFunctions::printerr("Failed to find bone ", bone_name);
+					LOG_ERROR(logger, "Failed to find bone ", bone_name);
 					continue;
 				}
-				String parent_name = api_str_to_godot(Bone_GetParentName, bone);
+				const String &parent_name = bone.parent_name;
 				if (parent_name.length() > 0) {
-					Node3D *parent_bone = named_bones.get(parent_name);
+					Node3D *parent_bone = named_bones.has(parent_name) ? named_bones.get(parent_name) : nullptr;
 					if (parent_bone == nullptr) {
-						UtilityFunctions::printerr("Bone ", bone_name, " references a parent ", parent_name, " that does not exist");
+						LOG_ERROR(logger, "Bone ", bone_name, " references a parent ", parent_name, " that does not exist");
 					} else {
 						make_parent_and_owner(parent_bone, bone_node);
 					}
 				}
 				// Set local position and rotation
 				// Note the inversion of the X axis
-				LibSWBF2::Vector3 pz = Bone_GetPosition(bone);
-				LibSWBF2::Vector4 rz = Bone_GetRotation(bone);
+				const LibSWBF2::Vector3 &pz = bone.position;
+				const LibSWBF2::Vector4 &rz = bone.rotation;
 				bone_node->set_position(Vector3(pz.m_X, pz.m_Y, pz.m_Z));
 				bone_node->set_quaternion(Quaternion(rz.m_X, rz.m_Y, rz.m_Z, rz.m_W));
 			}
 		}
 
 		// Organize SWBF2 mesh segments by bone
-		TList<const Segment> model_segments = Model_GetSegmentsT(model);
-		HashMap<String, List<const Segment *>> bone_segments;
-		for (size_t i = 0; i < model_segments.size(); ++ i) {
-			const Segment *segment = model_segments.at(i);
-			String segment_bone = api_str_to_godot(Segment_GetBoneName, segment);
-			if (!bone_segments.has(segment_bone)) {
-				bone_segments.insert(segment_bone, List<const Segment *>());
+		HashMap<String, std::vector<const SegmentView *>> bone_segments;
+		for (const SegmentView &segment : model.segments) {
+			if (!bone_segments.has(segment.bone_name)) {
+				bone_segments.insert(segment.bone_name, std::vector<const SegmentView *>());
 			}
-			List<const Segment *> *bsl = bone_segments.getptr(segment_bone);
-			bsl->push_back(segment);
+			std::vector<const SegmentView *> *bsl = bone_segments.getptr(segment.bone_name);
+			bsl->push_back(&segment);
 		}
 
 		// Create mesh nodes
 		for (const auto &key_pair : bone_segments) {
 			const String &bone_name = key_pair.key;
-			const List<const Segment *> &segments = key_pair.value;
+			const std::vector<const SegmentView *> &segments = key_pair.value;
 			MeshInstance3D *mesh = memnew(MeshInstance3D);
 			if (mesh == nullptr) {
-				UtilityFunctions::printerr("memnew failed to allocate a MeshInstance3D");
+				LOG_ERROR(logger, "memnew failed to allocate a MeshInstance3D");
 				continue;
 			}
 			String mesh_name = String(model_name) + String("_") + bone_name + String("_") + "mesh";
 			mesh->set_name(make_name_valid(mesh_name));
 			// TODO: LVLImport only applies override_texture to skinned meshes (bone_name == ""). Why?
-			segments_to_mesh(mesh, segments, override_texture, scene_dir);
+			segments_to_mesh(mesh, segments, override_texture, asset_dir);
 
 			// Parent our mesh to the bone node
-			Node *bone_node = root->find_child(bone_name, true, true);
+			Node *bone_node = find_indexed(node_index, bone_name);
 			if (bone_node) {
-				printdebug("Attaching mesh ", mesh_name, " to ", bone_name);
+				LOG_TRACE(logger, "Attaching mesh ", mesh_name, " to ", bone_name);
 				make_parent_and_owner(bone_node, mesh);
 			} else {
 				make_parent_and_owner(root, mesh);
-				UtilityFunctions::printerr("Could not find bone node ", bone_name, "; attaching ", mesh_name, " to model root");
+				LOG_ERROR(logger, "Could not find bone node ", bone_name, "; attaching ", mesh_name, " to model root");
 			}
+			index_node(node_index, mesh);
 		}
 
-		// Create collision bodies
-		TList<const CollisionPrimitive> collision_primitives = Model_GetCollisionPrimitivesT(model);
-		for (size_t i = 0; i < collision_primitives.size(); ++ i) {
-			const CollisionPrimitive *collision_primitive = collision_primitives.at(i);
-			String parent_name = api_str_to_godot(CollisionPrimitive_GetParentName, collision_primitive);
-
-			StaticBody3D *static_body = memnew(StaticBody3D);
-			if (static_body == nullptr) {
-				UtilityFunctions::printerr("memnew failed to allocate a StaticBody3D");
-				continue;
+		// Create collision bodies. With merge_collision every shape of the
+		// model goes on one body at the model root instead, each shape
+		// carrying its bone's transform.
+		StaticBody3D *model_body = nullptr;
+		if (options.merge_collision && (model.collision_primitives.size() > 0 || model.collision_index_count > 0)) {
+			model_body = memnew(StaticBody3D);
+			if (model_body == nullptr) {
+				LOG_ERROR(logger, "memnew failed to allocate a StaticBody3D");
+				return;
 			}
-			static_body->set_name(make_name_valid(parent_name + "_collision_primitive"));
+			model_body->set_name(make_name_valid(model_name + "_collision"));
+			report.add_count("collision_bodies");
+			make_parent_and_owner(root, model_body);
+			index_node(node_index, model_body);
+		}
 
-			LibSWBF2::Vector3 pz = CollisionPrimitive_GetPosition(collision_primitive);
-			LibSWBF2::Vector4 rz = CollisionPrimitive_GetRotation(collision_primitive);
-			static_body->set_position(Vector3(pz.m_X, pz.m_Y, pz.m_Z));
-			static_body->set_quaternion(Quaternion(rz.m_X, rz.m_Y, rz.m_Z, rz.m_W));
+		for (const CollisionPrimitiveView &primitive : model.collision_primitives) {
+			const String &parent_name = primitive.parent_name;
 
-			Node *parent_node = root->find_child(parent_name, true, true);
-			if (parent_node) {
-				printdebug("Attaching collision primitive to ", parent_name);
-				make_parent_and_owner(parent_node, static_body);
-			} else {
-				make_parent_and_owner(root, static_body);
-				UtilityFunctions::printerr("Could not find parent node ", parent_name, "; attaching collision primitive to model root");
+			Ref<Shape3D> shape = create_collision_primitive_shape(primitive);
+			if (shape.is_null()) {
+				continue;
 			}
-
 			CollisionShape3D *collision_shape = memnew(CollisionShape3D);
 			if (collision_shape == nullptr) {
-				UtilityFunctions::printerr("memnew failed to allocate a CollisionShape3D");
+				LOG_ERROR(logger, "memnew failed to allocate a CollisionShape3D");
 				continue;
 			}
 			collision_shape->set_name(make_name_valid(parent_name + "_collision_shape"));
+			collision_shape->set_shape(shape);
 
-			ECollisionPrimitiveType pt = CollisionPrimitive_GetType(collision_primitive);
-			switch (pt) {
-				case ECollisionPrimitiveType::Cube: {
-					float sx = 0.0f, sy = 0.0f, sz = 0.0f;
-					CollisionPrimitive_GetCubeDims(collision_primitive, &sx, &sy, &sz);
-					Ref<BoxShape3D> shape;
-					shape.instantiate();
-					shape->set_size(Vector3(sx * 2, sy * 2, sz * 2));
-					collision_shape->set_shape(shape);
-					break;
-				}
-				case ECollisionPrimitiveType::Cylinder: {
-					float sr = 0.0f, sh = 0.0f;
-					CollisionPrimitive_GetCylinderDims(collision_primitive, &sr, &sh);
-					Ref<CylinderShape3D> shape;
-					shape.instantiate();
-					shape->set_radius(sr);
-					shape->set_height(sh);
-					collision_shape->set_shape(shape);
-					break;
-				}
-				case ECollisionPrimitiveType::Sphere: {
-					float sr = 0.0f;
-					CollisionPrimitive_GetSphereRadius(collision_primitive, &sr);
-					Ref<SphereShape3D> shape;
-					shape.instantiate();
-					shape->set_radius(sr);
-					collision_shape->set_shape(shape);
-					break;
+			const LibSWBF2::Vector3 &pz = primitive.position;
+			const LibSWBF2::Vector4 &rz = primitive.rotation;
+			Transform3D primitive_transform(Basis(Quaternion(rz.m_X, rz.m_Y, rz.m_Z, rz.m_W)), Vector3(pz.m_X, pz.m_Y, pz.m_Z));
+
+			Node *parent_node = find_indexed(node_index, parent_name);
+			if (parent_node == nullptr) {
+				LOG_ERROR(logger, "Could not find parent node ", parent_name, "; attaching collision primitive to model root");
+			}
+			if (model_body != nullptr) {
+				Transform3D parent_transform = parent_node ? get_relative_transform(parent_node, root) : Transform3D();
+				collision_shape->set_transform(parent_transform * primitive_transform);
+				make_parent_and_owner(model_body, collision_shape);
+			} else {
+				StaticBody3D *static_body = memnew(StaticBody3D);
+				if (static_body == nullptr) {
+					LOG_ERROR(logger, "memnew failed to allocate a StaticBody3D");
+					memdelete(collision_shape);
+					continue;
 				}
-				default:
-					UtilityFunctions::printerr("Skipping unsupported collision primitive type ", (int)pt);
-					break;
+				static_body->set_name(make_name_valid(parent_name + "_collision_primitive"));
+				report.add_count("collision_bodies");
+				static_body->set_transform(primitive_transform);
+				LOG_TRACE(logger, "Attaching collision primitive to ", parent_name);
+				make_parent_and_owner(parent_node ? parent_node : root, static_body);
+				index_node(node_index, static_body);
+				make_parent_and_owner(static_body, collision_shape);
 			}
-			make_parent_and_owner(static_body, collision_shape);
+			index_node(node_index, collision_shape);
 		}
 
-		// A model always has a collision mesh object, but it may be empty
 		do {
-			const CollisionMesh *collision_mesh = Model_GetCollisionMesh(model);
-			TList<uint16_t> index_buffer = CollisionMesh_GetIndexBufferT(collision_mesh);
-			if (index_buffer.size() > 0) {
-				TList<LibSWBF2::Vector3> vertex_buffer = CollisionMesh_GetVertexBufferT(collision_mesh);
-				StaticBody3D *static_body = memnew(StaticBody3D);
+			if (model.collision_index_count == 0) {
+				break;
+			}
+			StaticBody3D *static_body = model_body;
+			if (static_body == nullptr) {
+				static_body = memnew(StaticBody3D);
 				if (static_body == nullptr) {
-					UtilityFunctions::printerr("memnew failed to allocate a StaticBody3D");
+					LOG_ERROR(logger, "memnew failed to allocate a StaticBody3D");
 					break;
 				}
 				static_body->set_name(make_name_valid("collision_mesh"));
+				report.add_count("collision_bodies");
 				make_parent_and_owner(root, static_body);
+				index_node(node_index, static_body);
+			}
 
-				CollisionShape3D *collision_shape = memnew(CollisionShape3D);
-				if (collision_shape == nullptr) {
-					UtilityFunctions::printerr("memnew failed to allocate a CollisionShape3D");
+			PackedVector3Array mesh_faces;
+			mesh_faces.resize(model.collision_index_count);
+			Vector3 *faces = mesh_faces.ptrw();
+			bool index_valid = true;
+			for (size_t i = 0; i < model.collision_index_count; ++ i) {
+				uint16_t index = model.collision_index[i];
+				if (index >= model.collision_vertex_count) {
+					index_valid = false;
 					break;
 				}
-				collision_shape->set_name(make_name_valid("collision_mesh_shape"));
-				make_parent_and_owner(static_body, collision_shape);
+				const LibSWBF2::Vector3 &v = model.collision_vertex[index];
+				faces[i] = Vector3(v.m_X, v.m_Y, v.m_Z);
+			}
+			if (!index_valid) {
+				LOG_ERROR(logger, "Skipping collision mesh of ", model_name, " with out of range indices");
+				break;
+			}
 
+			std::vector<std::pair<String, Ref<Shape3D>>> shapes;
+			if (options.convex_collision_hulls > 0) {
+				ScopedPhase phase(report, "collision_decompose");
+				ConvexDecompositionParams params;
+				params.max_hulls = options.convex_collision_hulls;
+				params.max_error = options.convex_collision_error;
+				ConvexDecomposition decomposition;
+				decompose_convex(mesh_faces.ptr(), mesh_faces.size(), params, pool, decomposition);
+				LOG_TRACE(logger, "Decomposed collision mesh of ", model_name, " into ", (int64_t)decomposition.hulls.size(), " hulls with error ", decomposition.error);
+				report.add_count("collision_hulls", decomposition.hulls.size());
+				report.add_metric("collision_hull_error", decomposition.error);
+				for (size_t i = 0; i < decomposition.hulls.size(); ++ i) {
+					Ref<ConvexPolygonShape3D> hull_shape;
+					hull_shape.instantiate();
+					hull_shape->set_points(decomposition.hulls[i]);
+					shapes.push_back({ "collision_mesh_hull_" + itos(i), hull_shape });
+				}
+			} else {
 				Ref<ConcavePolygonShape3D> mesh_shape;
 				mesh_shape.instantiate();
+				mesh_shape->set_faces(mesh_faces);
+				mesh_shape->set_backface_collision_enabled(true);
+				shapes.push_back({ "collision_mesh_shape", mesh_shape });
+			}
+
+			for (const std::pair<String, Ref<Shape3D>> &shape : shapes) {
+				CollisionShape3D *collision_shape = memnew(CollisionShape3D);
+				if (collision_shape == nullptr) {
+					LOG_ERROR(logger, "memnew failed to allocate a CollisionShape3D");
+					continue;
+				}
+				collision_shape->set_name(make_name_valid(shape.first));
+				collision_shape->set_shape(shape.second);
+				make_parent_and_owner(static_body, collision_shape);
+				index_node(node_index, collision_shape);
+			}
+		} while (0);
+	}
 
-				PackedVector3Array mesh_faces;
-				mesh_faces.resize(index_buffer.size());
+	void hash_model(const String &model_name, ContentHasher &hasher) {
+		hasher.add(model_name);
+		read_model(model_name, [&](const ModelView &model) {
+			for (const BoneView &bone : model.bones) {
+				hasher.add(bone.name);
+				hasher.add(bone.parent_name);
+				hasher.add(bone.position);
+				hasher.add(bone.rotation);
+			}
 
-				for (size_t i = 0; i < index_buffer.size(); ++ i) {
-					const LibSWBF2::Vector3 &v = *vertex_buffer.at(*index_buffer.at(i));
-					mesh_faces[i] = Vector3(v.m_X, v.m_Y, v.m_Z);
+			for (const SegmentView &segment : model.segments) {
+				const SegmentBuffers &buffers = segment.buffers;
+				hasher.add(segment.bone_name);
+				hasher.add(buffers.topology);
+				hasher.add_bytes(buffers.index, buffers.index_count * sizeof(uint16_t));
+				hasher.add_bytes(buffers.vertex, buffers.vertex_count * sizeof(LibSWBF2::Vector3));
+				hasher.add_bytes(buffers.tex_uv, buffers.tex_uv_count * sizeof(LibSWBF2::Vector2));
+				hasher.add_bytes(buffers.normal, buffers.normal_count * sizeof(LibSWBF2::Vector3));
+				if (segment.material.present) {
+					hasher.add(segment.material.flags);
+					for (int slot = 0; slot < 2; ++ slot) {
+						if (!segment.material.texture_name[slot].is_empty()) {
+							hasher.add(segment.material.texture_name[slot]);
+						}
+					}
 				}
+			}
 
-				mesh_shape->set_faces(mesh_faces);
-				mesh_shape->set_backface_collision_enabled(true);
+			for (const CollisionPrimitiveView &primitive : model.collision_primitives) {
+				hasher.add(primitive.parent_name);
+				hasher.add(primitive.position);
+				hasher.add(primitive.rotation);
+				hasher.add(primitive.type);
+				hasher.add(primitive.dims);
+			}
+
+			hasher.add_bytes(model.collision_index, model.collision_index_count * sizeof(uint16_t));
+			hasher.add_bytes(model.collision_vertex, model.collision_vertex_count * sizeof(LibSWBF2::Vector3));
+		});
+	}
 
-				collision_shape->set_shape(mesh_shape);
+	// Hash of everything an entity class scene is built from: its
+	// properties, the models they reference and any attached classes
+	uint64_t entity_class_content_hash(const String &entity_class_name) {
+		if (const uint64_t *hash = entity_class_hashes.getptr(entity_class_name)) {
+			return *hash;
+		}
+		entity_class_hashes.insert(entity_class_name, 0); // Breaks attachment cycles
+
+		ContentHasher hasher;
+		hasher.add(entity_class_name);
+		hasher.add(options.optimize_meshes);
+		hasher.add(options.merge_collision);
+		hasher.add(options.convex_collision_hulls);
+		hasher.add(options.convex_collision_error);
+		EntityClassView entity_class;
+		if (read_entity_class(entity_class_name, entity_class)) {
+			hasher.add(entity_class.base_name);
+			for (const std::pair<uint32_t, String> &property : entity_class.properties) {
+				uint32_t property_hash = property.first;
+				const String &property_value = property.second;
+				hasher.add(property_hash);
+				hasher.add(property_value);
+				if (property_hash == fnv_hash("GeometryName")) {
+					hash_model(property_value, hasher);
+				} else if (property_hash == fnv_hash("AttachODF")) {
+					hasher.add(entity_class_content_hash(property_value));
+				}
 			}
-		} while (0);
+		}
+
+		uint64_t hash = hasher.get();
+		entity_class_hashes[entity_class_name] = hash;
+		return hash;
 	}
 
-	Node3D *import_entity_class(const String &entity_class_name, const String &scene_dir) {
-		printdebug("Importing EntityClass ", entity_class_name);
+	// Reuse the existing scenes of entity classes that haven't changed since
+	// the last import. These are skipped by texture collection and never
+	// rebuilt.
+	void find_cached_entity_classes(const std::vector<InstanceView> &instances) {
+		if (!options.use_cache) {
+			return;
+		}
+		uint32_t cached = 0;
+		for (const InstanceView &instance : instances) {
+			const String &entity_class_name = instance.entity_class_name;
+			if (entity_class_scenes.has(entity_class_name)) {
+				continue;
+			}
+			String cache_key = "entity_class:" + entity_class_name;
+			if (cache.is_fresh(cache_key, entity_class_content_hash(entity_class_name))) {
+				Ref<PackedScene> scene = load_resource(cache.get_path(cache_key));
+				if (scene.is_valid()) {
+					entity_class_scenes.insert(entity_class_name, scene);
+					report.add_count("cached_entity_classes");
+					cached += 1;
+				} else {
+					LOG_ERROR(logger, "Failed to load cached entity class ", entity_class_name, "; re-importing");
+				}
+			}
+		}
+		LOG_INFO(logger, "Reusing ", cached, " unchanged entity classes");
+	}
+
+	Node3D *import_entity_class(const String &entity_class_name, const String &asset_dir) {
+		LOG_TRACE(logger, "Importing EntityClass ", entity_class_name);
 
 		// If we've already loaded this entity class, return an instantiation
 		if (Node3D *instance = maybe_instantiate_entity_class(entity_class_name)) {
 			return instance;
 		}
+		ScopedAsset asset(report, "entity_class", entity_class_name);
+		report.add_count("entity_classes");
 
 		// Assert this instance is a type we understand
 		const char *valid_base_classes[] = {
@@ -845,10 +1673,10 @@ class WorldImporter {
 			"commandpost"
 		};
 		bool is_valid_base_class = false;
-		const EntityClass *entity_class = Container_FindEntityClass(container, FNVHashString(entity_class_name.utf8().get_data()));
+		EntityClassView entity_class;
 		String base_class_name = "NONE";
-		if (entity_class) {
-			base_class_name = api_str_to_godot(EntityClass_GetBaseName, entity_class);
+		if (read_entity_class(entity_class_name, entity_class)) {
+			base_class_name = entity_class.base_name;
 			for (const char *valid_base_class : valid_base_classes) {
 				if (strcmp(base_class_name.utf8(), valid_base_class) == 0) {
 					is_valid_base_class = true;
@@ -857,86 +1685,89 @@ class WorldImporter {
 			}
 		}
 		if (!is_valid_base_class) {
-			UtilityFunctions::printerr("Cannot import entity class ", entity_class_name, " of unknown base class ", base_class_name);
+			LOG_ERROR(logger, "Cannot import entity class ", entity_class_name, " of unknown base class ", base_class_name);
 			return nullptr;
 		}
 
 		// Perform the actual scene creation
-		printdebug("Creating entity class ", entity_class_name, " scene");
-		TList<uint32_t> property_hashes = EntityClass_GetAllPropertyHashesT(entity_class);
-		String scene_path = scene_dir + String("/") + String(entity_class_name) + String(".tscn");
+		LOG_TRACE(logger, "Creating entity class ", entity_class_name, " scene");
+		String scene_path = asset_dir + String("/") + String(entity_class_name) + options.get_scene_extension();
 		String next_attach_entity_class = "";
 		Node3D *root = memnew(Node3D);
 		if (root == nullptr) {
-			UtilityFunctions::printerr("memnew failed to allocate a Node3D");
+			LOG_ERROR(logger, "memnew failed to allocate a Node3D");
 			return nullptr;
 		}
 		root->set_name(make_name_valid(entity_class_name)); // Attachments seem to have no name, so we need a default
-		for (size_t pi = 0; pi < property_hashes.size(); ++ pi) {
-			uint32_t property_hash = *property_hashes.at(pi);
-			String property_value = api_str_to_godot(EntityClass_GetPropertyValue, entity_class, property_hash);
+		NodeIndex node_index;
+		for (const std::pair<uint32_t, String> &property : entity_class.properties) {
+			uint32_t property_hash = property.first;
+			const String &property_value = property.second;
 			switch (property_hash) {
-				case 1204317002: { // GeometryName
-					printdebug("Attaching model ", property_value, " to ", entity_class_name);
+				case fnv_hash("GeometryName"): {
+					LOG_TRACE(logger, "Attaching model ", property_value, " to ", entity_class_name);
 					// Determine our texture, which is a separate property
 					String override_texture = "";
-					for (size_t i = 0; i < property_hashes.size(); ++ i) {
-						if (*property_hashes.at(i) == 165377196) {
-							override_texture = api_str_to_godot(EntityClass_GetPropertyValue, entity_class, property_hash);
+					for (const std::pair<uint32_t, String> &other : entity_class.properties) {
+						if (other.first == fnv_hash("OverrideTexture")) {
+							override_texture = other.second;
 							break;
 						}
 					}
-					populate_model(root, property_value, override_texture, scene_dir);
+					populate_model(root, node_index, property_value, override_texture, asset_dir);
 					break;
 				}
-				case 2849035403: // AttachODF
+				case fnv_hash("AttachODF"):
 					next_attach_entity_class = property_value;
 					break;
-				case 1005041674: // AttachToHardpoint
+				case fnv_hash("AttachToHardpoint"):
 					if (next_attach_entity_class.length() > 0) {
-						printdebug("Attaching ", next_attach_entity_class, " to hardpoint ", property_value);
+						LOG_TRACE(logger, "Attaching ", next_attach_entity_class, " to hardpoint ", property_value);
 						// Find the child we are attaching to. Default to the root
 						Node *attach_to = root;
-						if (Node *attach_to_child = root->find_child(property_value, true, true)) {
+						if (Node *attach_to_child = find_indexed(node_index, property_value)) {
 							attach_to = attach_to_child;
 						} else {
-							UtilityFunctions::printerr("AttachToHardpoint child ", property_value, " not found; attaching to root");
+							LOG_ERROR(logger, "AttachToHardpoint child ", property_value, " not found; attaching to root");
 						}
-						Node *child = import_entity_class(next_attach_entity_class, scene_dir);
+						Node *child = import_entity_class(next_attach_entity_class, asset_dir);
 						if (child) {
 							make_parent_and_owner(attach_to, child);
+							index_node(node_index, child);
 						}
 						next_attach_entity_class = "";
 					} else {
-						UtilityFunctions::printerr("Skipping AttachToHardpoint ", property_value, " not preceeded by an AttachODF");
+						LOG_ERROR(logger, "Skipping AttachToHardpoint ", property_value, " not preceeded by an AttachODF");
 					}
 					break;
-				case 2555738718: // AnimationName
-				case 3779456605: // Animation
-					printdebug("Skipping animation ", property_value);
+				case fnv_hash("AnimationName"):
+				case fnv_hash("Animation"):
+					LOG_TRACE(logger, "Skipping animation ", property_value);
 					break;
-				case 1576910975: // SoldierCollision
-				case 4213956359: // OrdnanceCollision
+				case fnv_hash("SoldierCollision"):
+				case fnv_hash("OrdnanceCollision"):
 					// Silently ignore collision masking
 					break;
-				case 165377196: // OverrideTexture
+				case fnv_hash("OverrideTexture"):
 					// Silently ignore, only relevant in GeometryName
 					break;
-				case 2714356677: // FoleyFXGroups
+				case fnv_hash("FoleyFXGroup"):
 					break;
 				default:
-					UtilityFunctions::printerr("Skipping unknown property ", property_hash, " (hash) = ", property_value);
+					LOG_ERROR(logger, "Skipping unknown property ", property_hash, " (hash) = ", property_value);
 					break;
 			}
 		}
 		if (next_attach_entity_class != "") {
-			UtilityFunctions::printerr("Skipping AttachODF property ", next_attach_entity_class, " not followed by an AttachToHardpoint property");
+			LOG_ERROR(logger, "Skipping AttachODF property ", next_attach_entity_class, " not followed by an AttachToHardpoint property");
 		}
 
 		// Save the node as a scene
-		Error save_err = save_as_scene(root, scene_path);
+		Ref<PackedScene> scene;
+		Error save_err = save_as_scene(root, scene_path, scene);
 		if (save_err == Error::OK) {
-			entity_class_scenes.insert(entity_class_name, scene_path);
+			entity_class_scenes.insert(entity_class_name, scene);
+			cache.record("entity_class:" + entity_class_name, entity_class_content_hash(entity_class_name), scene_path);
 		}
 
 		// We still want to return an instantiation of the scene rather than our node
@@ -969,92 +1800,454 @@ class WorldImporter {
 		take_ownership(parent, child);
 	}
 
-	static Error save_as_scene(Node *node, String scene_path) {
-		printdebug("Saving packed scene ", scene_path);
-		Ref<PackedScene> scene;
+	// Saves a resource and points it at its new path without reading it
+	// back. Taking over the path also replaces any resource cached there by
+	// an earlier import, so everything referencing this Ref is saved as an
+	// external reference to the file.
+	Error save_resource(const Ref<Resource> &resource, const String &resource_path) {
+		ScopedPhase phase(report, "disk_write");
+		will_write(resource_path);
+		Error err;
+		on_main_thread([&] {
+			resource->take_over_path(resource_path);
+			err = ResourceSaver::get_singleton()->save(resource, resource_path, options.get_saver_flags());
+		});
+		if (err == Error::OK) {
+			report.add_file_written(resource_path);
+		}
+		return err;
+	}
+
+	Error save_as_scene(Node *node, const String &scene_path, Ref<PackedScene> &scene) {
+		LOG_TRACE(logger, "Saving packed scene ", scene_path);
 		scene.instantiate();
-		Error pack_err = scene->pack(node);
+		Error pack_err;
+		{
+			ScopedPhase phase(report, "scene_pack");
+			pack_err = scene->pack(node);
+		}
 		if (pack_err) {
-			UtilityFunctions::printerr("Error packing scene ", pack_err);
+			LOG_ERROR(logger, "Error packing scene ", pack_err);
 			return pack_err;
 		}
-		if (Error save_err = ResourceSaver::get_singleton()->save(scene, scene_path)) {
-			UtilityFunctions::printerr("Error saving scene ", save_err);
+		if (Error save_err = save_resource(scene, scene_path)) {
+			LOG_ERROR(logger, "Error saving scene ", save_err);
 			return save_err;
 		}
 		return Error::OK;
 	}
 
-	template <typename... Args> static void printdebug(const Variant &p_arg1, Args&&... p_args) {
-		UtilityFunctions::print(p_arg1, std::forward<Args>(p_args)...);
+	Error save_as_scene(Node *node, const String &scene_path) {
+		Ref<PackedScene> scene;
+		return save_as_scene(node, scene_path, scene);
 	}
 
 public:
-	WorldImporter() {
-		printdebug("Creating WorldImporter");
+	WorldImporter(const ImportOptions &options, AsyncImport *async = nullptr)
+		: options(options)
+		, logger(options.log_level)
+		, pool(options.thread_count)
+		, async(async)
+	{
+		LOG_TRACE(logger, "Creating WorldImporter");
 		container = Container_Create();
 	}
 
 	~WorldImporter() {
-		printdebug("Destroying WorldImporter");
+		LOG_TRACE(logger, "Destroying WorldImporter");
 		Container_Destroy(container);
 	}
 
-	void import_lvl(const String &lvl_filename, const String &scene_dir) {
-		printdebug("Importing ", lvl_filename);
-		// Load and verify our lvl contains one or more worlds, then import them
-		Level_Owned *level = Container_AddLevel(container, lvl_filename.utf8().get_data());
-		if (level == nullptr) {
-			UtilityFunctions::printerr("Failed to load level");
-			return;
+	bool ensure_dir_exists(const String &dir) {
+		if(!DirAccess::dir_exists_absolute(dir)) {
+			LOG_TRACE(logger, "Creating directory ", dir);
+			// Remember each directory we create, outermost first, so a
+			// cancelled import can remove them
+			size_t first_created = created_dirs.size();
+			for (String missing = dir; !missing.is_empty() && !DirAccess::dir_exists_absolute(missing); missing = missing.get_base_dir()) {
+				created_dirs.insert(created_dirs.begin() + first_created, missing);
+				if (missing.get_base_dir() == missing) {
+					break;
+				}
+			}
+			if (Error e = DirAccess::make_dir_recursive_absolute(dir)) {
+				LOG_ERROR(logger, "Could not create directory ", dir);
+				return false;
+			}
 		}
-		printdebug("Importing level ", api_str_to_godot(Level_GetName, level));
-		if (!Level_IsWorldLevel(level)) {
-			UtilityFunctions::printerr("Canceling import because ", lvl_filename, " is not a world level");
-			return;
+		return true;
+	}
+
+	// Call before writing path. Remembers it if nothing is there yet, so a
+	// cancelled background import removes only its own files and leaves
+	// those it overwrote, which the cache may still point at.
+	void will_write(const String &path) {
+		if (async && !FileAccess::file_exists(path)) {
+			created_files.push_back(path);
 		}
+	}
 
-		// Ensure our scene_dir exists
-		if(!DirAccess::dir_exists_absolute(scene_dir)) {
-			printdebug("Creating scene directory ", scene_dir);
-			if (Error e = DirAccess::make_dir_absolute(scene_dir)) {
-				UtilityFunctions::printerr("Could not create scene directory ", scene_dir);
-				return;
+	// Deletes every file this import created, then the directories it
+	// created if that leaves them empty
+	void delete_output() {
+		int64_t deleted = 0;
+		for (const String &path : created_files) {
+			// Jobs cancelled before decoding never wrote their PNG
+			if (!FileAccess::file_exists(path)) {
+				continue;
+			}
+			if (Error err = DirAccess::remove_absolute(path)) {
+				LOG_ERROR(logger, "Could not delete ", path, " ", err);
+			} else {
+				deleted += 1;
 			}
 		}
+		for (auto dir = created_dirs.rbegin(); dir != created_dirs.rend(); ++ dir) {
+			DirAccess::remove_absolute(*dir);
+		}
+		LOG_INFO(logger, "Deleted ", deleted, " files created before the import was cancelled");
+	}
 
+	// Imports every world in a loaded world level into one scene in
+	// scene_dir, sharing textures, materials and entity classes in asset_dir
+	void import_level(Level_Owned *level, const String &lvl_filename, const String &scene_dir, const String &asset_dir) {
 		Node *lvl_root = memnew(Node);
 		if (lvl_root == nullptr) {
-			UtilityFunctions::printerr("memnew failed to allocate a Node");
+			LOG_ERROR(logger, "memnew failed to allocate a Node");
 			return;
 		}
 		lvl_root->set_name(make_name_valid(lvl_filename.get_file()));
 		TList<const World> worlds = Level_GetWorldsT(level);
 		for (size_t i = 0; i < worlds.size(); ++ i) {
 			const World *world = worlds.at(i);
-			Node *world_node = import_world(world, scene_dir);
+			Node *world_node = import_world(world, scene_dir, asset_dir);
+			if (is_cancelled()) {
+				if (world_node) {
+					memdelete(world_node);
+				}
+				memdelete(lvl_root);
+				logger.flush();
+				return;
+			}
 			if (world_node) {
 				make_parent_and_owner(lvl_root, world_node);
-				printdebug("Adding world to lvl scene");
+				LOG_TRACE(logger, "Adding world to lvl scene");
 			} else {
-				UtilityFunctions::printerr("World ", api_str_to_godot(World_GetName, world), " failed to import");
+				LOG_ERROR(logger, "World ", api_str_to_godot(World_GetName, world), " failed to import");
 			}
 		}
-		if (save_as_scene(lvl_root, scene_dir + String("/") + lvl_root->get_name() + String(".tscn")) == Error::OK) {
-			printdebug("Import successful");
+		if (save_as_scene(lvl_root, scene_dir + String("/") + lvl_root->get_name() + options.get_scene_extension()) == Error::OK) {
+			LOG_INFO(logger, "Import successful");
 		}
 		memdelete(lvl_root);
+		logger.flush();
+	}
+
+	void import_lvl(const String &lvl_filename, const String &scene_dir) {
+		LOG_INFO(logger, "Importing ", lvl_filename);
+		// Load and verify our lvl contains one or more worlds, then import them
+		Level_Owned *level;
+		{
+			ScopedPhase phase(report, "load_level");
+			level = Container_AddLevel(container, lvl_filename.utf8().get_data());
+		}
+		if (level == nullptr) {
+			LOG_ERROR(logger, "Failed to load level");
+			return;
+		}
+		LOG_INFO(logger, "Importing level ", api_str_to_godot(Level_GetName, level));
+		if (!Level_IsWorldLevel(level)) {
+			LOG_ERROR(logger, "Canceling import because ", lvl_filename, " is not a world level");
+			return;
+		}
+
+		// Ensure our scene_dir exists
+		if (!ensure_dir_exists(scene_dir)) {
+			return;
+		}
+		if (options.use_cache) {
+			cache.load(scene_dir, options.get_output_format_name());
+		}
+
+		import_level(level, lvl_filename, scene_dir, scene_dir);
+
+		if (options.use_cache && !is_cancelled()) {
+			cache.save();
+		}
 		Level_Destroy(level);
 	}
+
+	// Loads every lvl into our one container before importing any worlds,
+	// so worlds can reference assets from common.lvl, core.lvl and friends
+	// without reloading them. Each world level gets its own directory
+	// under out_root, and all of them share one deduplicated asset
+	// directory and cache.
+	void import_lvls(const Array &lvl_filenames, const String &out_root) {
+		String asset_dir = out_root + String("/shared");
+		if (!ensure_dir_exists(asset_dir)) {
+			return;
+		}
+		if (options.use_cache) {
+			cache.load(asset_dir, options.get_output_format_name());
+		}
+
+		std::vector<std::pair<String, Level_Owned *>> levels;
+		for (int64_t i = 0; i < lvl_filenames.size() && !is_cancelled(); ++ i) {
+			String lvl_filename = lvl_filenames[i];
+			set_progress("load_level", i, lvl_filenames.size());
+			LOG_INFO(logger, "Loading ", lvl_filename);
+			Level_Owned *level;
+			{
+				ScopedPhase phase(report, "load_level");
+				level = Container_AddLevel(container, lvl_filename.utf8().get_data());
+			}
+			if (level == nullptr) {
+				LOG_ERROR(logger, "Failed to load level ", lvl_filename);
+				continue;
+			}
+			levels.push_back({ lvl_filename, level });
+		}
+
+		for (const std::pair<String, Level_Owned *> &entry : levels) {
+			const String &lvl_filename = entry.first;
+			Level_Owned *level = entry.second;
+			if (is_cancelled()) {
+				break;
+			}
+			if (!Level_IsWorldLevel(level)) {
+				LOG_INFO(logger, "Not importing ", lvl_filename, " which is not a world level");
+				continue;
+			}
+			LOG_INFO(logger, "Importing level ", api_str_to_godot(Level_GetName, level));
+			String scene_dir = out_root + String("/") + lvl_filename.get_file().get_basename();
+			if (!ensure_dir_exists(scene_dir)) {
+				continue;
+			}
+			import_level(level, lvl_filename, scene_dir, asset_dir);
+		}
+
+		if (options.use_cache && !is_cancelled()) {
+			cache.save();
+		}
+		for (const std::pair<String, Level_Owned *> &entry : levels) {
+			Level_Destroy(entry.second);
+		}
+	}
+
+	// Imports a generated world through the same entity class, model,
+	// material, texture, instance and terrain code as a real level, reading
+	// it through the views LibSWBF2 data is read through. Only the skydome
+	// and reading terrain from LibSWBF2 are left out.
+	void import_synthetic(const SyntheticWorldParams &params, const String &scene_dir) {
+		if (!ensure_dir_exists(scene_dir)) {
+			return;
+		}
+		if (options.use_cache) {
+			cache.load(scene_dir, options.get_output_format_name());
+		}
+
+		SyntheticWorld world;
+		{
+			ScopedPhase phase(report, "generate");
+			generate_synthetic_world(params, world);
+		}
+		LOG_INFO(logger, "Importing synthetic world with ", (int64_t)world.instances.size(), " instances of ", (int64_t)world.entity_classes.size(), " entity classes");
+		synthetic = &world;
+
+		Node3D *world_root = memnew(Node3D);
+		if (world_root == nullptr) {
+			LOG_ERROR(logger, "memnew failed to allocate a Node3D");
+			synthetic = nullptr;
+			return;
+		}
+		world_root->set_name("synthetic");
+
+		{
+			ScopedPhase phase(report, "world_textures");
+			find_cached_entity_classes(world.instances);
+			HashMap<String, size_t> seen;
+			std::vector<TextureJob> jobs;
+			collect_instance_textures(world.instances, seen, jobs, scene_dir);
+			for (const String &layer : world.terrain_layers) {
+				collect_texture(nullptr, layer, TextureUsage::Albedo, seen, jobs, scene_dir);
+			}
+			import_textures(jobs, scene_dir);
+		}
+
+		import_instances(world.instances, world_root, scene_dir);
+
+		if (!world.terrain_index.empty()) {
+			ScopedPhase phase(report, "terrain");
+			ScopedAsset asset(report, "terrain", "synthetic");
+			TerrainMesh mesh;
+			{
+				ScopedPhase phase(report, "terrain_mesh");
+				build_terrain_mesh(world.terrain_vertex.data(), world.terrain_vertex.size(),
+				                   world.terrain_tex_uv.data(), world.terrain_tex_uv.size(),
+				                   world.terrain_index.data(), world.terrain_index.size(),
+				                   pool, mesh);
+			}
+			std::vector<Ref<ImageTexture>> layers;
+			for (const String &layer : world.terrain_layers) {
+				layers.push_back(maybe_load_texture(layer));
+			}
+			Ref<ShaderMaterial> terrain_material = create_terrain_material(world.blend_map.data(), world.blend_map_dim, world.terrain_layers.size(), layers, scene_dir);
+			if (Node3D *terrain = create_terrain(mesh, "synthetic", terrain_material, scene_dir)) {
+				make_parent_and_owner(world_root, terrain);
+			}
+		}
+
+		if (save_as_scene(world_root, scene_dir + String("/synthetic") + options.get_scene_extension()) == Error::OK) {
+			LOG_INFO(logger, "Import successful");
+		}
+		memdelete(world_root);
+		synthetic = nullptr;
+		if (options.use_cache) {
+			cache.save();
+		}
+		logger.flush();
+	}
+
+	// Returns the report of everything imported so far, also writing it to
+	// the report_path option if one was given
+	Dictionary get_report() {
+		if (!options.report_path.is_empty()) {
+			if (Error err = report.save_json(options.report_path, options.report_top_n)) {
+				LOG_ERROR(logger, "Error saving import report ", options.report_path, " ", err);
+			}
+		}
+		return report.to_dictionary(options.report_top_n);
+	}
+
+	// Ends a background import, deleting its output if it was cancelled
+	Dictionary finish_async() {
+		bool cancelled = is_cancelled();
+		if (cancelled) {
+			delete_output();
+		}
+		logger.flush();
+		Dictionary result = get_report();
+		result["cancelled"] = cancelled;
+		return result;
+	}
 };
 
 void LVLImport::_bind_methods() {
-	godot::ClassDB::bind_static_method("LVLImport", godot::D_METHOD("import_lvl"), &LVLImport::import_lvl);
+	godot::ClassDB::bind_static_method("LVLImport", godot::D_METHOD("import_lvl", "lvl_filename", "scene_dir", "options"), &LVLImport::import_lvl, DEFVAL(Dictionary()));
+	godot::ClassDB::bind_static_method("LVLImport", godot::D_METHOD("import_lvls", "lvl_filenames", "out_root", "options"), &LVLImport::import_lvls, DEFVAL(Dictionary()));
+	godot::ClassDB::bind_static_method("LVLImport", godot::D_METHOD("import_synthetic", "scene_dir", "params", "options"), &LVLImport::import_synthetic, DEFVAL(Dictionary()), DEFVAL(Dictionary()));
+	godot::ClassDB::bind_method(godot::D_METHOD("import_lvl_async", "lvl_filename", "scene_dir", "options"), &LVLImport::import_lvl_async, DEFVAL(Dictionary()));
+	godot::ClassDB::bind_method(godot::D_METHOD("import_lvls_async", "lvl_filenames", "out_root", "options"), &LVLImport::import_lvls_async, DEFVAL(Dictionary()));
+	godot::ClassDB::bind_method(godot::D_METHOD("cancel_import"), &LVLImport::cancel_import);
+	godot::ClassDB::bind_method(godot::D_METHOD("is_importing"), &LVLImport::is_importing);
+	ADD_SIGNAL(MethodInfo("progress", PropertyInfo(Variant::STRING, "phase"), PropertyInfo(Variant::INT, "done"), PropertyInfo(Variant::INT, "total")));
+	ADD_SIGNAL(MethodInfo("finished", PropertyInfo(Variant::DICTIONARY, "report")));
+}
+
+LVLImport::LVLImport() {}
+
+LVLImport::~LVLImport() {
+	if (async_import) {
+		async_import->cancel_requested = true;
+		async_import->close();
+		import_thread.join();
+	}
 }
 
-void LVLImport::import_lvl(const String &lvl_filename, const String &scene_dir) {
-	WorldImporter importer;
+Dictionary LVLImport::import_lvl(const String &lvl_filename, const String &scene_dir, const Dictionary &options) {
+	WorldImporter importer(ImportOptions::from_dictionary(options));
 	importer.import_lvl(lvl_filename, scene_dir);
+	return importer.get_report();
+}
+
+Dictionary LVLImport::import_lvls(const Array &lvl_filenames, const String &out_root, const Dictionary &options) {
+	WorldImporter importer(ImportOptions::from_dictionary(options));
+	importer.import_lvls(lvl_filenames, out_root);
+	return importer.get_report();
+}
+
+Dictionary LVLImport::import_synthetic(const String &scene_dir, const Dictionary &params, const Dictionary &options) {
+	WorldImporter importer(ImportOptions::from_dictionary(options));
+	importer.import_synthetic(SyntheticWorldParams::from_dictionary(params), scene_dir);
+	return importer.get_report();
+}
+
+Error LVLImport::start_async_import(const std::function<Dictionary(AsyncImport &)> &run) {
+	if (async_import) {
+		UtilityFunctions::printerr("An import is already running on this LVLImport");
+		return Error::ERR_BUSY;
+	}
+	if (!is_inside_tree()) {
+		UtilityFunctions::printerr("LVLImport must be inside the scene tree to import in the background");
+		return Error::ERR_UNCONFIGURED;
+	}
+	async_import = std::make_unique<AsyncImport>();
+	AsyncImport *async = async_import.get();
+	import_thread = std::thread([async, run]() {
+		async->report = run(*async);
+		async->finished = true;
+	});
+	set_process(true);
+	return Error::OK;
+}
+
+Error LVLImport::import_lvl_async(const String &lvl_filename, const String &scene_dir, const Dictionary &options) {
+	ImportOptions import_options = ImportOptions::from_dictionary(options);
+	return start_async_import([=](AsyncImport &async) {
+		WorldImporter importer(import_options, &async);
+		importer.import_lvl(lvl_filename, scene_dir);
+		return importer.finish_async();
+	});
+}
+
+Error LVLImport::import_lvls_async(const Array &lvl_filenames, const String &out_root, const Dictionary &options) {
+	ImportOptions import_options = ImportOptions::from_dictionary(options);
+	return start_async_import([=](AsyncImport &async) {
+		WorldImporter importer(import_options, &async);
+		importer.import_lvls(lvl_filenames, out_root);
+		return importer.finish_async();
+	});
+}
+
+void LVLImport::cancel_import() {
+	if (async_import) {
+		async_import->cancel_requested = true;
+	}
+}
+
+bool LVLImport::is_importing() const {
+	return async_import != nullptr;
+}
+
+void LVLImport::_process(double delta) {
+	if (!async_import) {
+		set_process(false);
+		return;
+	}
+	async_import->run_main_thread_calls(MAIN_THREAD_BUDGET_USEC);
+
+	String phase;
+	int64_t done, total;
+	if (async_import->take_progress(phase, done, total)) {
+		emit_signal("progress", phase, done, total);
+	}
+
+	if (async_import->finished) {
+		import_thread.join();
+		Dictionary report = async_import->report;
+		async_import.reset();
+		set_process(false);
+		emit_signal("finished", report);
+	}
+}
+
+void LVLImport::_exit_tree() {
+	// Nothing will run the import's main thread calls from here on, so
+	// cancel it and let it finish on its own thread
+	if (async_import) {
+		async_import->cancel_requested = true;
+		async_import->close();
+	}
 }
 
 }
@@ -2,17 +2,55 @@
 #define LVLIMPORT_TEST_HPP_
 
 #include <godot_cpp/classes/node.hpp>
+#include <godot_cpp/variant/array.hpp>
+#include <godot_cpp/variant/dictionary.hpp>
 #include <godot_cpp/variant/string.hpp>
+#include <functional>
+#include <memory>
+#include <thread>
 
 namespace godot {
 
+class AsyncImport;
+
 class LVLImport : public Node {
 	GDCLASS(LVLImport, Node)
 
+	std::unique_ptr<AsyncImport> async_import;
+	std::thread import_thread;
+
+	Error start_async_import(const std::function<Dictionary(AsyncImport &)> &run);
+
 protected:
 	static void _bind_methods();
 public:
-	static void import_lvl(const String &lvl_filename, const String &scene_dir);
+	LVLImport();
+	~LVLImport();
+
+	// Both return the import report described in import_report.hpp
+	static Dictionary import_lvl(const String &lvl_filename, const String &scene_dir, const Dictionary &options);
+	static Dictionary import_lvls(const Array &lvl_filenames, const String &out_root, const Dictionary &options);
+	// Imports a generated world sized by params, see synthetic_world.hpp,
+	// for measuring the importer without SWBF2's game data. It goes through
+	// the same entity class, model, material, texture, instance and terrain
+	// code as import_lvl, skipping only LibSWBF2 itself and the skydome.
+	static Dictionary import_synthetic(const String &scene_dir, const Dictionary &params, const Dictionary &options);
+
+	// Run the imports above on a background thread, so the editor stays
+	// responsive, and return at once. The node must be inside the tree,
+	// since it runs the import's resource loads and saves on the main thread
+	// from _process. Emits progress(phase, done, total) as the import goes
+	// and finished(report) once it's done, with report["cancelled"] set if
+	// cancel_import() stopped it. One import runs per node at a time.
+	Error import_lvl_async(const String &lvl_filename, const String &scene_dir, const Dictionary &options);
+	Error import_lvls_async(const Array &lvl_filenames, const String &out_root, const Dictionary &options);
+	// Stops the running import at its next instance or texture and deletes
+	// every file and directory it created. Files it overwrote are kept.
+	void cancel_import();
+	bool is_importing() const;
+
+	void _process(double delta) override;
+	void _exit_tree() override;
 };
 
 }
@@ -0,0 +1,353 @@
+#include "mesh_optimize.hpp"
+#include <godot_cpp/classes/mesh.hpp>
+#include <godot_cpp/core/defs.hpp>
+#include <godot_cpp/variant/packed_color_array.hpp>
+#include <godot_cpp/variant/packed_float32_array.hpp>
+#include <godot_cpp/variant/packed_int32_array.hpp>
+#include <godot_cpp/variant/packed_vector2_array.hpp>
+#include <godot_cpp/variant/packed_vector3_array.hpp>
+#include <algorithm>
+#include <cmath>
+
+namespace godot {
+
+float compute_acmr(const int32_t *index, uint32_t index_count, uint32_t vertex_count, uint32_t cache_size) {
+	const uint32_t triangle_count = index_count / 3;
+	if (triangle_count == 0) {
+		return 0;
+	}
+	// A vertex is cached if it was loaded within the last cache_size misses
+	std::vector<uint32_t> loaded_at(vertex_count, 0);
+	uint32_t misses = 0;
+	for (uint32_t i = 0; i < triangle_count * 3; ++ i) {
+		uint32_t v = index[i];
+		if (loaded_at[v] == 0 || misses - loaded_at[v] + 1 > cache_size) {
+			misses += 1;
+			loaded_at[v] = misses;
+		}
+	}
+	return float(misses) / triangle_count;
+}
+
+// Forsyth's scoring, see https://tomforsyth1000.github.io/papers/fast_vert_cache_opt.html
+static constexpr int32_t FORSYTH_CACHE_SIZE = 32;
+
+static float forsyth_vertex_score(int32_t cache_position, uint32_t remaining_triangles) {
+	if (remaining_triangles == 0) {
+		return -1.0f;
+	}
+	float score = 0.0f;
+	if (cache_position >= 0) {
+		if (cache_position < 3) {
+			score = 0.75f;
+		} else {
+			const float scaler = 1.0f / (FORSYTH_CACHE_SIZE - 3);
+			score = std::pow(1.0f - (cache_position - 3) * scaler, 1.5f);
+		}
+	}
+	return score + 2.0f * std::pow(float(remaining_triangles), -0.5f);
+}
+
+void optimize_vertex_cache(int32_t *index, uint32_t index_count, uint32_t vertex_count) {
+	const uint32_t triangle_count = index_count / 3;
+	if (triangle_count == 0) {
+		return;
+	}
+
+	// Triangles around each vertex
+	std::vector<uint32_t> adjacency_offset(vertex_count + 1, 0);
+	for (uint32_t i = 0; i < triangle_count * 3; ++ i) {
+		adjacency_offset[index[i] + 1] += 1;
+	}
+	for (uint32_t v = 0; v < vertex_count; ++ v) {
+		adjacency_offset[v + 1] += adjacency_offset[v];
+	}
+	std::vector<uint32_t> adjacency(triangle_count * 3);
+	{
+		std::vector<uint32_t> cursor(adjacency_offset.begin(), adjacency_offset.end() - 1);
+		for (uint32_t i = 0; i < triangle_count * 3; ++ i) {
+			adjacency[cursor[index[i]]++] = i / 3;
+		}
+	}
+
+	std::vector<uint32_t> remaining(vertex_count);
+	std::vector<int32_t> cache_position(vertex_count, -1);
+	std::vector<float> vertex_score(vertex_count);
+	for (uint32_t v = 0; v < vertex_count; ++ v) {
+		remaining[v] = adjacency_offset[v + 1] - adjacency_offset[v];
+		vertex_score[v] = forsyth_vertex_score(-1, remaining[v]);
+	}
+	std::vector<float> triangle_score(triangle_count);
+	for (uint32_t t = 0; t < triangle_count; ++ t) {
+		const int32_t *tri = index + t * 3;
+		triangle_score[t] = vertex_score[tri[0]] + vertex_score[tri[1]] + vertex_score[tri[2]];
+	}
+	std::vector<uint8_t> emitted(triangle_count, 0);
+	std::vector<int32_t> output(triangle_count * 3);
+
+	// Room for the cache plus the three vertices pushed by a new triangle
+	int32_t cache[FORSYTH_CACHE_SIZE + 3];
+	int32_t cache_count = 0;
+	uint32_t next_unemitted = 0;
+
+	uint32_t best = 0;
+	for (uint32_t t = 1; t < triangle_count; ++ t) {
+		if (triangle_score[t] > triangle_score[best]) {
+			best = t;
+		}
+	}
+
+	for (uint32_t o = 0; o < triangle_count; ++ o) {
+		if (best == UINT32_MAX) {
+			// Nothing in the cache has triangles left, start somewhere new
+			while (emitted[next_unemitted]) {
+				next_unemitted += 1;
+			}
+			best = next_unemitted;
+		}
+		const int32_t *tri = index + best * 3;
+		emitted[best] = 1;
+		output[o * 3 + 0] = tri[0];
+		output[o * 3 + 1] = tri[1];
+		output[o * 3 + 2] = tri[2];
+
+		// Remove the triangle from its vertices' remaining lists
+		for (int j = 0; j < 3; ++ j) {
+			uint32_t v = tri[j];
+			uint32_t *begin = adjacency.data() + adjacency_offset[v];
+			uint32_t *end = begin + remaining[v];
+			*std::find(begin, end, best) = *(end - 1);
+			remaining[v] -= 1;
+		}
+
+		// Move the triangle's vertices to the front of the LRU cache
+		int32_t new_cache[FORSYTH_CACHE_SIZE + 3];
+		int32_t new_count = 0;
+		for (int j = 0; j < 3; ++ j) {
+			if (std::find(new_cache, new_cache + new_count, tri[j]) == new_cache + new_count) {
+				new_cache[new_count++] = tri[j];
+			}
+		}
+		for (int32_t c = 0; c < cache_count; ++ c) {
+			int32_t v = cache[c];
+			if (v != tri[0] && v != tri[1] && v != tri[2]) {
+				new_cache[new_count++] = v;
+			}
+		}
+		for (int32_t c = FORSYTH_CACHE_SIZE; c < new_count; ++ c) {
+			cache_position[new_cache[c]] = -1;
+			vertex_score[new_cache[c]] = forsyth_vertex_score(-1, remaining[new_cache[c]]);
+		}
+		cache_count = MIN(new_count, FORSYTH_CACHE_SIZE);
+		std::copy(new_cache, new_cache + cache_count, cache);
+
+		// Rescore everything in the cache and pick the best triangle touching it
+		for (int32_t c = 0; c < cache_count; ++ c) {
+			cache_position[cache[c]] = c;
+			vertex_score[cache[c]] = forsyth_vertex_score(c, remaining[cache[c]]);
+		}
+		best = UINT32_MAX;
+		float best_score = -1.0f;
+		for (int32_t c = 0; c < cache_count; ++ c) {
+			uint32_t v = cache[c];
+			for (uint32_t a = adjacency_offset[v]; a < adjacency_offset[v] + remaining[v]; ++ a) {
+				uint32_t t = adjacency[a];
+				const int32_t *adjacent = index + t * 3;
+				float score = vertex_score[adjacent[0]] + vertex_score[adjacent[1]] + vertex_score[adjacent[2]];
+				triangle_score[t] = score;
+				if (score > best_score || (score == best_score && t < best)) {
+					best_score = score;
+					best = t;
+				}
+			}
+		}
+	}
+
+	std::copy(output.begin(), output.end(), index);
+}
+
+void optimize_overdraw(const Vector3 *vertex, int32_t *index, uint32_t index_count, uint32_t vertex_count, float threshold) {
+	const uint32_t triangle_count = index_count / 3;
+	if (triangle_count < 2) {
+		return;
+	}
+	const float acmr = compute_acmr(index, index_count, vertex_count);
+
+	// Start a new cluster wherever a triangle misses the cache entirely
+	std::vector<uint32_t> cluster_start;
+	{
+		const uint32_t cache_size = 16;
+		std::vector<uint32_t> loaded_at(vertex_count, 0);
+		uint32_t misses = 0;
+		for (uint32_t t = 0; t < triangle_count; ++ t) {
+			uint32_t triangle_misses = 0;
+			for (int j = 0; j < 3; ++ j) {
+				uint32_t v = index[t * 3 + j];
+				if (loaded_at[v] == 0 || misses - loaded_at[v] + 1 > cache_size) {
+					misses += 1;
+					loaded_at[v] = misses;
+					triangle_misses += 1;
+				}
+			}
+			if (t == 0 || triangle_misses == 3) {
+				cluster_start.push_back(t);
+			}
+		}
+	}
+	const uint32_t cluster_count = cluster_start.size();
+	if (cluster_count < 2) {
+		return;
+	}
+	cluster_start.push_back(triangle_count);
+
+	// Sort clusters so those facing away from the mesh centre draw first
+	Vector3 mesh_centroid;
+	float mesh_area = 0;
+	std::vector<Vector3> cluster_centroid(cluster_count);
+	std::vector<Vector3> cluster_normal(cluster_count);
+	for (uint32_t c = 0; c < cluster_count; ++ c) {
+		Vector3 centroid;
+		Vector3 normal;
+		float area = 0;
+		for (uint32_t t = cluster_start[c]; t < cluster_start[c + 1]; ++ t) {
+			const Vector3 &v0 = vertex[index[t * 3 + 0]];
+			const Vector3 &v1 = vertex[index[t * 3 + 1]];
+			const Vector3 &v2 = vertex[index[t * 3 + 2]];
+			Vector3 cross = (v1 - v0).cross(v2 - v0);
+			float a = cross.length();
+			centroid += (v0 + v1 + v2) * (a / 3.0f);
+			normal += cross;
+			area += a;
+		}
+		mesh_centroid += centroid;
+		mesh_area += area;
+		cluster_centroid[c] = area > 0 ? centroid / area : centroid;
+		// Clockwise front faces, so the outward normal is the negated cross
+		cluster_normal[c] = -normal.normalized();
+	}
+	if (mesh_area > 0) {
+		mesh_centroid /= mesh_area;
+	}
+	std::vector<float> cluster_key(cluster_count);
+	std::vector<uint32_t> order(cluster_count);
+	for (uint32_t c = 0; c < cluster_count; ++ c) {
+		cluster_key[c] = (cluster_centroid[c] - mesh_centroid).dot(cluster_normal[c]);
+		order[c] = c;
+	}
+	std::stable_sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) {
+		return cluster_key[a] > cluster_key[b];
+	});
+
+	std::vector<int32_t> output;
+	output.reserve(triangle_count * 3);
+	for (uint32_t c : order) {
+		output.insert(output.end(), index + cluster_start[c] * 3, index + cluster_start[c + 1] * 3);
+	}
+	if (compute_acmr(output.data(), output.size(), vertex_count) <= acmr * threshold) {
+		std::copy(output.begin(), output.end(), index);
+	}
+}
+
+void optimize_vertex_fetch(int32_t *index, uint32_t index_count, uint32_t vertex_count, std::vector<uint32_t> &remap) {
+	constexpr uint32_t NONE = UINT32_MAX;
+	remap.assign(vertex_count, NONE);
+	uint32_t next = 0;
+	for (uint32_t i = 0; i < index_count; ++ i) {
+		uint32_t &r = remap[index[i]];
+		if (r == NONE) {
+			r = next++;
+		}
+		index[i] = r;
+	}
+	for (uint32_t v = 0; v < vertex_count; ++ v) {
+		if (remap[v] == NONE) {
+			remap[v] = next++;
+		}
+	}
+}
+
+// Moves element v of a per-vertex array to remap[v], for arrays holding
+// stride values per vertex. Arrays of any other length are left alone.
+template <typename PackedArray>
+static void permute_vertex_array(Variant &value, uint32_t vertex_count, const std::vector<uint32_t> &remap) {
+	PackedArray array = value;
+	if (vertex_count == 0 || array.size() % vertex_count != 0 || array.is_empty()) {
+		return;
+	}
+	const uint32_t stride = array.size() / vertex_count;
+	PackedArray permuted;
+	permuted.resize(array.size());
+	const auto *src = array.ptr();
+	auto *dst = permuted.ptrw();
+	for (uint32_t v = 0; v < vertex_count; ++ v) {
+		for (uint32_t s = 0; s < stride; ++ s) {
+			dst[remap[v] * stride + s] = src[v * stride + s];
+		}
+	}
+	value = permuted;
+}
+
+static bool indices_in_range(const PackedInt32Array &index, uint32_t vertex_count) {
+	const int32_t *p = index.ptr();
+	for (int64_t i = 0; i < index.size(); ++ i) {
+		if (p[i] < 0 || uint32_t(p[i]) >= vertex_count) {
+			return false;
+		}
+	}
+	return true;
+}
+
+MeshOptimizeReport optimize_surface_arrays(Array &mesh_data, Dictionary &lods) {
+	MeshOptimizeReport report;
+	PackedVector3Array vertex = mesh_data[Mesh::ArrayType::ARRAY_VERTEX];
+	PackedInt32Array index = mesh_data[Mesh::ArrayType::ARRAY_INDEX];
+	const uint32_t vertex_count = vertex.size();
+	if (index.size() < 3 || !indices_in_range(index, vertex_count)) {
+		return report;
+	}
+	Array lod_keys = lods.keys();
+	for (int64_t l = 0; l < lod_keys.size(); ++ l) {
+		if (!indices_in_range(lods[lod_keys[l]], vertex_count)) {
+			return report;
+		}
+	}
+
+	report.acmr_before = compute_acmr(index.ptr(), index.size(), vertex_count);
+	optimize_vertex_cache(index.ptrw(), index.size(), vertex_count);
+	optimize_overdraw(vertex.ptr(), index.ptrw(), index.size(), vertex_count);
+
+	std::vector<uint32_t> remap;
+	optimize_vertex_fetch(index.ptrw(), index.size(), vertex_count, remap);
+	for (int64_t a = 0; a < mesh_data.size(); ++ a) {
+		if (a == Mesh::ArrayType::ARRAY_INDEX) {
+			continue;
+		}
+		Variant value = mesh_data[a];
+		switch (value.get_type()) {
+			case Variant::PACKED_VECTOR3_ARRAY: permute_vertex_array<PackedVector3Array>(value, vertex_count, remap); break;
+			case Variant::PACKED_VECTOR2_ARRAY: permute_vertex_array<PackedVector2Array>(value, vertex_count, remap); break;
+			case Variant::PACKED_COLOR_ARRAY: permute_vertex_array<PackedColorArray>(value, vertex_count, remap); break;
+			case Variant::PACKED_FLOAT32_ARRAY: permute_vertex_array<PackedFloat32Array>(value, vertex_count, remap); break;
+			case Variant::PACKED_INT32_ARRAY: permute_vertex_array<PackedInt32Array>(value, vertex_count, remap); break;
+			default: continue;
+		}
+		mesh_data[a] = value;
+	}
+	mesh_data[Mesh::ArrayType::ARRAY_INDEX] = index;
+	report.acmr_after = compute_acmr(index.ptr(), index.size(), vertex_count);
+
+	for (int64_t l = 0; l < lod_keys.size(); ++ l) {
+		PackedInt32Array lod = lods[lod_keys[l]];
+		int32_t *p = lod.ptrw();
+		for (int64_t i = 0; i < lod.size(); ++ i) {
+			p[i] = remap[p[i]];
+		}
+		optimize_vertex_cache(p, lod.size(), vertex_count);
+		lods[lod_keys[l]] = lod;
+	}
+
+	report.optimized = true;
+	return report;
+}
+
+}
@@ -0,0 +1,46 @@
+#ifndef LVLIMPORT_MESH_OPTIMIZE_HPP_
+#define LVLIMPORT_MESH_OPTIMIZE_HPP_
+
+#include <godot_cpp/variant/array.hpp>
+#include <godot_cpp/variant/dictionary.hpp>
+#include <godot_cpp/variant/vector3.hpp>
+#include <cstdint>
+#include <vector>
+
+namespace godot {
+
+// Average cache miss ratio: vertex shader invocations per triangle through a
+// FIFO post-transform cache. 0.5 is ideal for a large regular grid and 3 is
+// the worst possible.
+float compute_acmr(const int32_t *index, uint32_t index_count, uint32_t vertex_count, uint32_t cache_size = 16);
+
+// Tom Forsyth's linear-speed vertex cache optimization, reordering triangles
+// in place for an LRU cache of 32 vertices.
+void optimize_vertex_cache(int32_t *index, uint32_t index_count, uint32_t vertex_count);
+
+// Reorders the triangles of an already cache optimized index buffer to draw
+// outward facing clusters first, in the manner of Tipsify. Clusters are
+// split where the cache is cold and the new order is only kept if its ACMR
+// is within threshold of the input's.
+void optimize_overdraw(const Vector3 *vertex, int32_t *index, uint32_t index_count, uint32_t vertex_count, float threshold = 1.05f);
+
+// Renumbers vertices in order of first use, rewriting index in place.
+// Fills remap with each old vertex's new position. Unreferenced vertices
+// are moved to the end.
+void optimize_vertex_fetch(int32_t *index, uint32_t index_count, uint32_t vertex_count, std::vector<uint32_t> &remap);
+
+struct MeshOptimizeReport {
+	bool optimized = false;
+	float acmr_before = 0;
+	float acmr_after = 0;
+};
+
+// Runs every stage on a triangle surface in the layout passed to
+// ArrayMesh::add_surface_from_arrays. Every per-vertex array is permuted
+// with the vertices and every LOD index array in lods is remapped and cache
+// optimized too. Surfaces with out of range indices are left untouched.
+MeshOptimizeReport optimize_surface_arrays(Array &mesh_data, Dictionary &lods);
+
+}
+
+#endif
@@ -0,0 +1,249 @@
+#include "normal_kernel.hpp"
+#include "worker_pool.hpp"
+#include <godot_cpp/core/defs.hpp>
+#include <cmath>
+#include <vector>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define LVLIMPORT_NORMALS_AVX2
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define LVLIMPORT_NORMALS_SSE2
+#endif
+
+namespace godot {
+
+static inline void normalize_scalar(float &x, float &y, float &z) {
+	float l = x * x + y * y + z * z;
+	if (l == 0) {
+		x = y = z = 0;
+	} else {
+		l = std::sqrt(l);
+		x /= l;
+		y /= l;
+		z /= l;
+	}
+}
+
+static inline void face_normal_scalar(const float *x, const float *y, const float *z, const int32_t *tri, float &nx, float &ny, float &nz) {
+	const float ax = x[tri[1]] - x[tri[0]];
+	const float ay = y[tri[1]] - y[tri[0]];
+	const float az = z[tri[1]] - z[tri[0]];
+	const float bx = x[tri[2]] - x[tri[0]];
+	const float by = y[tri[2]] - y[tri[0]];
+	const float bz = z[tri[2]] - z[tri[0]];
+	nx = ay * bz - az * by;
+	ny = az * bx - ax * bz;
+	nz = ax * by - ay * bx;
+	normalize_scalar(nx, ny, nz);
+}
+
+#if defined(LVLIMPORT_NORMALS_AVX2)
+
+static inline void normalize_simd(__m256 &x, __m256 &y, __m256 &z) {
+	__m256 l = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(x, x), _mm256_mul_ps(y, y)), _mm256_mul_ps(z, z));
+	// Unordered, like _mm_cmpneq_ps and the scalar l == 0 test, so NaN
+	// lengths give NaN normals on every path
+	__m256 nonzero = _mm256_cmp_ps(l, _mm256_setzero_ps(), _CMP_NEQ_UQ);
+	l = _mm256_sqrt_ps(l);
+	x = _mm256_and_ps(_mm256_div_ps(x, l), nonzero);
+	y = _mm256_and_ps(_mm256_div_ps(y, l), nonzero);
+	z = _mm256_and_ps(_mm256_div_ps(z, l), nonzero);
+}
+
+void compute_face_normals(const float *x, const float *y, const float *z, const int32_t *index,
+                          uint32_t begin, uint32_t end, float *nx, float *ny, float *nz) {
+	const __m256i stride = _mm256_setr_epi32(0, 3, 6, 9, 12, 15, 18, 21);
+	uint32_t t = begin;
+	for (; t + 8 <= end; t += 8) {
+		const int32_t *tri = index + t * 3;
+		__m256i i0 = _mm256_i32gather_epi32(tri + 0, stride, 4);
+		__m256i i1 = _mm256_i32gather_epi32(tri + 1, stride, 4);
+		__m256i i2 = _mm256_i32gather_epi32(tri + 2, stride, 4);
+		__m256 x0 = _mm256_i32gather_ps(x, i0, 4);
+		__m256 y0 = _mm256_i32gather_ps(y, i0, 4);
+		__m256 z0 = _mm256_i32gather_ps(z, i0, 4);
+		__m256 ax = _mm256_sub_ps(_mm256_i32gather_ps(x, i1, 4), x0);
+		__m256 ay = _mm256_sub_ps(_mm256_i32gather_ps(y, i1, 4), y0);
+		__m256 az = _mm256_sub_ps(_mm256_i32gather_ps(z, i1, 4), z0);
+		__m256 bx = _mm256_sub_ps(_mm256_i32gather_ps(x, i2, 4), x0);
+		__m256 by = _mm256_sub_ps(_mm256_i32gather_ps(y, i2, 4), y0);
+		__m256 bz = _mm256_sub_ps(_mm256_i32gather_ps(z, i2, 4), z0);
+		__m256 cx = _mm256_sub_ps(_mm256_mul_ps(ay, bz), _mm256_mul_ps(az, by));
+		__m256 cy = _mm256_sub_ps(_mm256_mul_ps(az, bx), _mm256_mul_ps(ax, bz));
+		__m256 cz = _mm256_sub_ps(_mm256_mul_ps(ax, by), _mm256_mul_ps(ay, bx));
+		normalize_simd(cx, cy, cz);
+		_mm256_storeu_ps(nx + t, cx);
+		_mm256_storeu_ps(ny + t, cy);
+		_mm256_storeu_ps(nz + t, cz);
+	}
+	for (; t < end; ++ t) {
+		face_normal_scalar(x, y, z, index + t * 3, nx[t], ny[t], nz[t]);
+	}
+}
+
+void normalize_vectors(float *x, float *y, float *z, uint32_t begin, uint32_t end) {
+	uint32_t i = begin;
+	for (; i + 8 <= end; i += 8) {
+		__m256 vx = _mm256_loadu_ps(x + i);
+		__m256 vy = _mm256_loadu_ps(y + i);
+		__m256 vz = _mm256_loadu_ps(z + i);
+		normalize_simd(vx, vy, vz);
+		_mm256_storeu_ps(x + i, vx);
+		_mm256_storeu_ps(y + i, vy);
+		_mm256_storeu_ps(z + i, vz);
+	}
+	for (; i < end; ++ i) {
+		normalize_scalar(x[i], y[i], z[i]);
+	}
+}
+
+#elif defined(LVLIMPORT_NORMALS_SSE2)
+
+static inline void normalize_simd(__m128 &x, __m128 &y, __m128 &z) {
+	__m128 l = _mm_add_ps(_mm_add_ps(_mm_mul_ps(x, x), _mm_mul_ps(y, y)), _mm_mul_ps(z, z));
+	__m128 nonzero = _mm_cmpneq_ps(l, _mm_setzero_ps());
+	l = _mm_sqrt_ps(l);
+	x = _mm_and_ps(_mm_div_ps(x, l), nonzero);
+	y = _mm_and_ps(_mm_div_ps(y, l), nonzero);
+	z = _mm_and_ps(_mm_div_ps(z, l), nonzero);
+}
+
+static inline __m128 gather4(const float *p, const int32_t *tri) {
+	return _mm_setr_ps(p[tri[0]], p[tri[3]], p[tri[6]], p[tri[9]]);
+}
+
+void compute_face_normals(const float *x, const float *y, const float *z, const int32_t *index,
+                          uint32_t begin, uint32_t end, float *nx, float *ny, float *nz) {
+	uint32_t t = begin;
+	for (; t + 4 <= end; t += 4) {
+		const int32_t *tri = index + t * 3;
+		__m128 x0 = gather4(x, tri);
+		__m128 y0 = gather4(y, tri);
+		__m128 z0 = gather4(z, tri);
+		__m128 ax = _mm_sub_ps(gather4(x, tri + 1), x0);
+		__m128 ay = _mm_sub_ps(gather4(y, tri + 1), y0);
+		__m128 az = _mm_sub_ps(gather4(z, tri + 1), z0);
+		__m128 bx = _mm_sub_ps(gather4(x, tri + 2), x0);
+		__m128 by = _mm_sub_ps(gather4(y, tri + 2), y0);
+		__m128 bz = _mm_sub_ps(gather4(z, tri + 2), z0);
+		__m128 cx = _mm_sub_ps(_mm_mul_ps(ay, bz), _mm_mul_ps(az, by));
+		__m128 cy = _mm_sub_ps(_mm_mul_ps(az, bx), _mm_mul_ps(ax, bz));
+		__m128 cz = _mm_sub_ps(_mm_mul_ps(ax, by), _mm_mul_ps(ay, bx));
+		normalize_simd(cx, cy, cz);
+		_mm_storeu_ps(nx + t, cx);
+		_mm_storeu_ps(ny + t, cy);
+		_mm_storeu_ps(nz + t, cz);
+	}
+	for (; t < end; ++ t) {
+		face_normal_scalar(x, y, z, index + t * 3, nx[t], ny[t], nz[t]);
+	}
+}
+
+void normalize_vectors(float *x, float *y, float *z, uint32_t begin, uint32_t end) {
+	uint32_t i = begin;
+	for (; i + 4 <= end; i += 4) {
+		__m128 vx = _mm_loadu_ps(x + i);
+		__m128 vy = _mm_loadu_ps(y + i);
+		__m128 vz = _mm_loadu_ps(z + i);
+		normalize_simd(vx, vy, vz);
+		_mm_storeu_ps(x + i, vx);
+		_mm_storeu_ps(y + i, vy);
+		_mm_storeu_ps(z + i, vz);
+	}
+	for (; i < end; ++ i) {
+		normalize_scalar(x[i], y[i], z[i]);
+	}
+}
+
+#else
+
+void compute_face_normals(const float *x, const float *y, const float *z, const int32_t *index,
+                          uint32_t begin, uint32_t end, float *nx, float *ny, float *nz) {
+	for (uint32_t t = begin; t < end; ++ t) {
+		face_normal_scalar(x, y, z, index + t * 3, nx[t], ny[t], nz[t]);
+	}
+}
+
+void normalize_vectors(float *x, float *y, float *z, uint32_t begin, uint32_t end) {
+	for (uint32_t i = begin; i < end; ++ i) {
+		normalize_scalar(x[i], y[i], z[i]);
+	}
+}
+
+#endif
+
+// Runs fn over [0, count) in chunks which begin on kernel width boundaries
+template <typename Fn>
+static void parallel_for_aligned(WorkerPool &pool, uint32_t count, Fn &&fn) {
+	const uint32_t blocks = (count + NORMAL_KERNEL_WIDTH - 1) / NORMAL_KERNEL_WIDTH;
+	pool.parallel_for(blocks, [&](uint32_t, uint32_t begin, uint32_t end) {
+		fn(begin * NORMAL_KERNEL_WIDTH, MIN(end * NORMAL_KERNEL_WIDTH, count));
+	}, 512);
+}
+
+void generate_vertex_normals(const PackedVector3Array &vertex, const PackedInt32Array &index, WorkerPool &pool, PackedVector3Array &normal) {
+	const uint32_t vertex_count = vertex.size();
+	const uint32_t triangle_count = index.size() / 3;
+	const Vector3 *v = vertex.ptr();
+	const int32_t *tri = index.ptr();
+
+	std::vector<float> x(vertex_count), y(vertex_count), z(vertex_count);
+	pool.parallel_for(vertex_count, [&](uint32_t, uint32_t begin, uint32_t end) {
+		for (uint32_t i = begin; i < end; ++ i) {
+			x[i] = v[i].x;
+			y[i] = v[i].y;
+			z[i] = v[i].z;
+		}
+	});
+
+	std::vector<float> fx(triangle_count), fy(triangle_count), fz(triangle_count);
+	parallel_for_aligned(pool, triangle_count, [&](uint32_t begin, uint32_t end) {
+		compute_face_normals(x.data(), y.data(), z.data(), tri, begin, end, fx.data(), fy.data(), fz.data());
+	});
+
+	// Gather the faces around each vertex in triangle order, so each vertex
+	// sums its face normals in exactly the order a serial pass would
+	std::vector<uint32_t> vertex_face_offset(vertex_count + 1, 0);
+	for (uint32_t i = 0; i < triangle_count * 3; ++ i) {
+		vertex_face_offset[tri[i] + 1] += 1;
+	}
+	for (uint32_t i = 0; i < vertex_count; ++ i) {
+		vertex_face_offset[i + 1] += vertex_face_offset[i];
+	}
+	std::vector<uint32_t> vertex_faces(triangle_count * 3);
+	{
+		std::vector<uint32_t> cursor(vertex_face_offset.begin(), vertex_face_offset.end() - 1);
+		for (uint32_t i = 0; i < triangle_count * 3; ++ i) {
+			vertex_faces[cursor[tri[i]]++] = i / 3;
+		}
+	}
+
+	// Clockwise faces have counter clockwise cross products, so subtract
+	// them. The position arrays are reused for the sums.
+	parallel_for_aligned(pool, vertex_count, [&](uint32_t begin, uint32_t end) {
+		for (uint32_t i = begin; i < end; ++ i) {
+			float sx = 0, sy = 0, sz = 0;
+			for (uint32_t f = vertex_face_offset[i]; f < vertex_face_offset[i + 1]; ++ f) {
+				sx -= fx[vertex_faces[f]];
+				sy -= fy[vertex_faces[f]];
+				sz -= fz[vertex_faces[f]];
+			}
+			x[i] = sx;
+			y[i] = sy;
+			z[i] = sz;
+		}
+		normalize_vectors(x.data(), y.data(), z.data(), begin, end);
+	});
+
+	normal.resize(vertex_count);
+	Vector3 *n = normal.ptrw();
+	pool.parallel_for(vertex_count, [&](uint32_t, uint32_t begin, uint32_t end) {
+		for (uint32_t i = begin; i < end; ++ i) {
+			n[i] = Vector3(x[i], y[i], z[i]);
+		}
+	});
+}
+
+}
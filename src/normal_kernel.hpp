@@ -0,0 +1,37 @@
+#ifndef LVLIMPORT_NORMAL_KERNEL_HPP_
+#define LVLIMPORT_NORMAL_KERNEL_HPP_
+
+#include <godot_cpp/variant/packed_int32_array.hpp>
+#include <godot_cpp/variant/packed_vector3_array.hpp>
+#include <cstdint>
+
+namespace godot {
+
+class WorkerPool;
+
+// Triangles processed together by the vectorized kernels. Callers splitting
+// work across threads should split on multiples of this so the same
+// triangles always take the same path.
+constexpr uint32_t NORMAL_KERNEL_WIDTH = 8;
+
+// Writes the unit normal cross(v1 - v0, v2 - v0) of triangles [begin, end)
+// from structure of arrays positions. Uses AVX2 or SSE2 when the build
+// targets them and falls back to scalar code otherwise. Every path performs
+// the same IEEE operations in the same order as Vector3::cross and
+// Vector3::normalized, so results are bit identical between paths, NaNs
+// included. See tests/test_normal_kernel.cpp.
+void compute_face_normals(const float *x, const float *y, const float *z, const int32_t *index,
+                          uint32_t begin, uint32_t end, float *nx, float *ny, float *nz);
+
+// Vector3::normalize of elements [begin, end) in place
+void normalize_vectors(float *x, float *y, float *z, uint32_t begin, uint32_t end);
+
+// Smooth vertex normals for triangles with Godot's clockwise front faces.
+// Each vertex sums the normals of its faces in triangle order, so the result
+// is the same for any number of threads. Every index must be less than the
+// vertex count.
+void generate_vertex_normals(const PackedVector3Array &vertex, const PackedInt32Array &index, WorkerPool &pool, PackedVector3Array &normal);
+
+}
+
+#endif
@@ -0,0 +1,54 @@
+#include "packed_convert.hpp"
+#include <cstring>
+#include <type_traits>
+
+namespace godot {
+
+template <typename From, typename To>
+static constexpr bool same_layout = sizeof(From) == sizeof(To) && std::is_trivially_copyable<From>::value && std::is_trivially_copyable<To>::value;
+
+static_assert(sizeof(uint16_t) * 2 == sizeof(int32_t), "index widening assumes 16 and 32 bit indices");
+
+void copy_to_packed(const LibSWBF2::Vector3 *src, size_t count, PackedVector3Array &dst) {
+	dst.resize(count);
+	if (count == 0) {
+		return;
+	}
+	Vector3 *out = dst.ptrw();
+	if constexpr (same_layout<LibSWBF2::Vector3, Vector3> && std::is_same<real_t, float>::value) {
+		memcpy(out, src, count * sizeof(Vector3));
+	} else {
+		for (size_t i = 0; i < count; ++ i) {
+			out[i] = Vector3(src[i].m_X, src[i].m_Y, src[i].m_Z);
+		}
+	}
+}
+
+void copy_to_packed(const LibSWBF2::Vector2 *src, size_t count, PackedVector2Array &dst) {
+	dst.resize(count);
+	if (count == 0) {
+		return;
+	}
+	Vector2 *out = dst.ptrw();
+	if constexpr (same_layout<LibSWBF2::Vector2, Vector2> && std::is_same<real_t, float>::value) {
+		memcpy(out, src, count * sizeof(Vector2));
+	} else {
+		for (size_t i = 0; i < count; ++ i) {
+			out[i] = Vector2(src[i].m_X, src[i].m_Y);
+		}
+	}
+}
+
+void widen_to_packed(const uint16_t *src, size_t count, PackedInt32Array &dst) {
+	dst.resize(count);
+	if (count == 0) {
+		return;
+	}
+	const uint16_t *__restrict in = src;
+	int32_t *__restrict out = dst.ptrw();
+	for (size_t i = 0; i < count; ++ i) {
+		out[i] = in[i];
+	}
+}
+
+}
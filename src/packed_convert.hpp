@@ -0,0 +1,26 @@
+#ifndef LVLIMPORT_PACKED_CONVERT_HPP_
+#define LVLIMPORT_PACKED_CONVERT_HPP_
+
+#include <godot_cpp/variant/packed_int32_array.hpp>
+#include <godot_cpp/variant/packed_vector2_array.hpp>
+#include <godot_cpp/variant/packed_vector3_array.hpp>
+#include <LibSWBF2/API.h>
+#include <cstddef>
+#include <cstdint>
+
+namespace godot {
+
+// Bulk conversions from LibSWBF2 buffers into Godot packed arrays. Each
+// resizes its destination once and fills it through a single write pointer,
+// so there is one copy-on-write check per array rather than per element.
+// Vectors are memcpy'd when both types share a layout, which is the case
+// unless Godot is built with double precision.
+void copy_to_packed(const LibSWBF2::Vector3 *src, size_t count, PackedVector3Array &dst);
+void copy_to_packed(const LibSWBF2::Vector2 *src, size_t count, PackedVector2Array &dst);
+
+// Widens 16 bit indices in a single pass the compiler can vectorize
+void widen_to_packed(const uint16_t *src, size_t count, PackedInt32Array &dst);
+
+}
+
+#endif
@@ -4,6 +4,10 @@
 #include <godot_cpp/core/defs.hpp>
 #include <godot_cpp/godot.hpp>
 
+#ifdef LVLIMPORT_TESTS
+#include "lvlimport_tests.hpp"
+#endif
+
 using namespace godot;
 
 void initialize_lvlimport_module(ModuleInitializationLevel p_level) {
@@ -12,6 +16,9 @@ void initialize_lvlimport_module(ModuleInitializationLevel p_level) {
 	}
 
 	GDREGISTER_CLASS(LVLImport);
+#ifdef LVLIMPORT_TESTS
+	GDREGISTER_CLASS(LVLImportTests);
+#endif
 }
 
 void uninitialize_lvlimport_module(ModuleInitializationLevel p_level) {
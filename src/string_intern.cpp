@@ -0,0 +1,24 @@
+#include "string_intern.hpp"
+#include <LibSWBF2/API.h>
+
+namespace godot {
+
+const String &StringInterner::intern(const char *data, size_t length) {
+	auto it = strings.find(std::string_view(data, length));
+	if (it != strings.end()) {
+		return it->second;
+	}
+	const std::string &key = storage.emplace_back(data, length);
+	return strings.emplace(std::string_view(key), String::utf8(key.c_str(), key.size())).first->second;
+}
+
+uint32_t StringInterner::hash(const String &name) {
+	if (const uint32_t *hash = hashes.getptr(name)) {
+		return *hash;
+	}
+	uint32_t hash = FNVHashString(name.utf8().get_data());
+	hashes.insert(name, hash);
+	return hash;
+}
+
+}
@@ -0,0 +1,32 @@
+#ifndef LVLIMPORT_STRING_INTERN_HPP_
+#define LVLIMPORT_STRING_INTERN_HPP_
+
+#include <godot_cpp/templates/hash_map.hpp>
+#include <godot_cpp/variant/string.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+namespace godot {
+
+// Converts each distinct string returned by LibSWBF2's C API into a Godot
+// String once, and hashes each distinct name passed back to Container_Find*
+// once. Returned references live as long as the interner. Not thread safe.
+class StringInterner {
+	std::deque<std::string> storage;
+	std::unordered_map<std::string_view, String> strings;
+	HashMap<String, uint32_t> hashes;
+
+public:
+	const String &intern(const char *data, size_t length);
+
+	// FNVHashString of name, as used to look up LibSWBF2 containers
+	uint32_t hash(const String &name);
+};
+
+}
+
+#endif
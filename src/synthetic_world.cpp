@@ -0,0 +1,422 @@
+#include "synthetic_world.hpp"
+#include "fnv.hpp"
+#include <godot_cpp/core/defs.hpp>
+#include <cmath>
+
+namespace godot {
+
+static constexpr uint32_t PATCH_QUADS = 8;
+static constexpr float TERRAIN_SPACING = 8.0f;
+static constexpr float TERRAIN_HEIGHT = 40.0f;
+static constexpr uint32_t SEGMENT_RINGS = 16;
+static constexpr uint32_t SEGMENT_SIDES = 16;
+static constexpr uint32_t COLLISION_SIDES = 8;
+
+static String texture_name(uint32_t texture) {
+	return "synthetic_" + itos(texture);
+}
+
+static String entity_class_name(uint32_t entity_class) {
+	return "synthetic_class_" + itos(entity_class);
+}
+
+static uint32_t get_clamped(const Dictionary &params, const char *key, int64_t fallback, int64_t min, int64_t max) {
+	int64_t value = params.get(key, fallback);
+	return CLAMP(value, min, max);
+}
+
+SyntheticWorldParams SyntheticWorldParams::from_dictionary(const Dictionary &params) {
+	SyntheticWorldParams p;
+	p.terrain_size = get_clamped(params, "terrain_size", p.terrain_size, 0, 4096);
+	p.instance_count = get_clamped(params, "instance_count", p.instance_count, 0, 1 << 20);
+	p.entity_classes = get_clamped(params, "entity_classes", p.entity_classes, 1, 1 << 16);
+	p.texture_count = get_clamped(params, "texture_count", p.texture_count, 1, 1 << 12);
+	p.texture_resolution = get_clamped(params, "texture_resolution", p.texture_resolution, 1, 4096);
+	p.bone_depth = get_clamped(params, "bone_depth", p.bone_depth, 1, 256);
+	p.strip_segments = get_clamped(params, "strip_segments", p.strip_segments, 0, 1024);
+	p.seed = get_clamped(params, "seed", p.seed, 0, UINT32_MAX);
+	return p;
+}
+
+// splitmix64, so sequences don't depend on the standard library
+class SyntheticRandom {
+	uint64_t state;
+
+public:
+	SyntheticRandom(uint64_t seed) : state(seed) {}
+
+	uint64_t next() {
+		uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+		z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+		z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+		return z ^ (z >> 31);
+	}
+
+	// [0, 1)
+	float unit() {
+		return (next() >> 40) * (1.0f / 16777216.0f);
+	}
+
+	uint32_t below(uint32_t n) {
+		return n ? next() % n : 0;
+	}
+};
+
+static float lattice(uint64_t seed, int32_t x, int32_t z) {
+	SyntheticRandom random(seed ^ (uint64_t(uint32_t(x)) << 32) ^ uint32_t(z));
+	return random.unit();
+}
+
+// Smoothly interpolated value noise in [0, 1), made only of additions and
+// multiplications so every platform generates the same terrain
+static float value_noise(uint64_t seed, float x, float z) {
+	int32_t x0 = int32_t(x);
+	int32_t z0 = int32_t(z);
+	float fx = x - x0;
+	float fz = z - z0;
+	fx = fx * fx * (3.0f - 2.0f * fx);
+	fz = fz * fz * (3.0f - 2.0f * fz);
+	float a = lattice(seed, x0, z0);
+	float b = lattice(seed, x0 + 1, z0);
+	float c = lattice(seed, x0, z0 + 1);
+	float d = lattice(seed, x0 + 1, z0 + 1);
+	float ab = a + (b - a) * fx;
+	float cd = c + (d - c) * fx;
+	return ab + (cd - ab) * fz;
+}
+
+static float terrain_height(uint64_t seed, float x, float z) {
+	float height = 0.0f;
+	float amplitude = 1.0f;
+	float frequency = 1.0f / 64.0f;
+	for (int octave = 0; octave < 4; ++ octave) {
+		height += value_noise(seed + octave, x * frequency, z * frequency) * amplitude;
+		amplitude *= 0.5f;
+		frequency *= 2.0f;
+	}
+	return height * TERRAIN_HEIGHT;
+}
+
+static void generate_terrain(const SyntheticWorldParams &params, SyntheticWorld &out) {
+	const uint32_t patches = (params.terrain_size + PATCH_QUADS - 1) / PATCH_QUADS;
+	const uint32_t patch_vertices = PATCH_QUADS + 1;
+	const uint64_t seed = uint64_t(params.seed) << 8;
+	out.terrain_vertex.reserve(patches * patches * patch_vertices * patch_vertices);
+	out.terrain_tex_uv.reserve(out.terrain_vertex.capacity());
+	out.terrain_index.reserve(patches * patches * PATCH_QUADS * PATCH_QUADS * 6);
+
+	for (uint32_t pz = 0; pz < patches; ++ pz) {
+	for (uint32_t px = 0; px < patches; ++ px) {
+		const uint32_t first = out.terrain_vertex.size();
+		for (uint32_t j = 0; j < patch_vertices; ++ j) {
+		for (uint32_t i = 0; i < patch_vertices; ++ i) {
+			float gx = float(px * PATCH_QUADS + i);
+			float gz = float(pz * PATCH_QUADS + j);
+			float x = gx * TERRAIN_SPACING;
+			float z = gz * TERRAIN_SPACING;
+			out.terrain_vertex.push_back({ x, terrain_height(seed, gx, gz), z });
+			out.terrain_tex_uv.push_back({ gx / PATCH_QUADS, gz / PATCH_QUADS });
+		}}
+		for (uint32_t j = 0; j < PATCH_QUADS; ++ j) {
+		for (uint32_t i = 0; i < PATCH_QUADS; ++ i) {
+			uint32_t v00 = first + j * patch_vertices + i;
+			uint32_t v10 = v00 + 1;
+			uint32_t v01 = v00 + patch_vertices;
+			uint32_t v11 = v01 + 1;
+			out.terrain_index.insert(out.terrain_index.end(), { v00, v01, v10, v10, v01, v11 });
+		}}
+	}}
+}
+
+// One blend map texel per terrain quad. Each layer's weight is a sharpened
+// noise field, so most texels are dominated by a few layers as they are in
+// painted terrain.
+static void generate_blend_map(const SyntheticWorldParams &params, SyntheticWorld &out) {
+	const uint32_t dim = (params.terrain_size + PATCH_QUADS - 1) / PATCH_QUADS * PATCH_QUADS;
+	const uint32_t layers = MIN(params.texture_count, 16u);
+	const uint64_t seed = (uint64_t(params.seed) << 8) ^ 0x80;
+	out.blend_map_dim = dim;
+	for (uint32_t l = 0; l < layers; ++ l) {
+		out.terrain_layers.push_back(texture_name(l));
+	}
+	out.blend_map.resize(dim * dim * layers);
+	uint8_t *texel = out.blend_map.data();
+	float weight[16];
+	for (uint32_t y = 0; y < dim; ++ y) {
+	for (uint32_t x = 0; x < dim; ++ x) {
+		float total = 0.0f;
+		for (uint32_t l = 0; l < layers; ++ l) {
+			float w = value_noise(seed + l, x / 16.0f, y / 16.0f);
+			w = w * w;
+			weight[l] = w * w;
+			total += weight[l];
+		}
+		for (uint32_t l = 0; l < layers; ++ l) {
+			*texel++ = total > 0.0f ? uint8_t(weight[l] / total * 255.0f) : 0;
+		}
+	}}
+}
+
+static void generate_textures(const SyntheticWorldParams &params, SyntheticWorld &out) {
+	const uint32_t resolution = params.texture_resolution;
+	for (uint32_t t = 0; t < params.texture_count; ++ t) {
+		SyntheticTexture texture;
+		texture.resolution = resolution;
+		texture.pixels.resize(resolution * resolution * 4);
+		uint8_t *pixel = texture.pixels.ptrw();
+		// Noise over a checker, so the textures neither compress to nothing
+		// nor are pure noise
+		SyntheticRandom random((uint64_t(params.seed) << 32) | t);
+		uint8_t tint[3] = { uint8_t(random.next()), uint8_t(random.next()), uint8_t(random.next()) };
+		const uint32_t checker = MAX(resolution / 8, 1u);
+		for (uint32_t y = 0; y < resolution; ++ y) {
+		for (uint32_t x = 0; x < resolution; ++ x) {
+			bool dark = ((x / checker) ^ (y / checker)) & 1;
+			uint8_t noise = random.next() & 0x3F;
+			for (int c = 0; c < 3; ++ c) {
+				*pixel++ = (dark ? tint[c] / 2 : tint[c]) / 2 + noise;
+			}
+			*pixel++ = 0xFF;
+		}}
+		out.textures.insert(texture_name(t), texture);
+	}
+}
+
+// Every second material has the next texture as its normal map, and every
+// fourth is transparent
+static void generate_materials(const SyntheticWorldParams &params, SyntheticWorld &out) {
+	out.materials.resize(params.texture_count);
+	for (uint32_t m = 0; m < params.texture_count; ++ m) {
+		MaterialView &material = out.materials[m];
+		material.present = true;
+		material.texture_name[0] = texture_name(m);
+		uint32_t flags = 0;
+		if (m % 2 == 1) {
+			material.texture_name[1] = texture_name((m + 1) % params.texture_count);
+			flags |= (uint32_t)LibSWBF2::EMaterialFlags::BumpMap;
+		}
+		if (m % 4 == 3) {
+			flags |= (uint32_t)LibSWBF2::EMaterialFlags::Transparent;
+		}
+		material.flags = LibSWBF2::EMaterialFlags(flags);
+	}
+}
+
+// A closed tube of SEGMENT_RINGS rings around the bone's Y axis. Each pair
+// of rings is one strip flagged at its start, as STRP chunks are.
+static void generate_segment(SyntheticRandom &random, bool with_normals, SyntheticSegment &segment) {
+	const float radius = 0.5f + random.unit();
+	const float height = 1.0f + 2.0f * random.unit();
+
+	// Rotate a unit vector around the circle by repeated multiplication
+	// with a fixed rotation, rather than calling sin and cos
+	const float step_cos = 0.92387953f; // cos(2 pi / 16)
+	const float step_sin = 0.38268343f;
+	float ring_x[SEGMENT_SIDES + 1];
+	float ring_z[SEGMENT_SIDES + 1];
+	ring_x[0] = 1.0f;
+	ring_z[0] = 0.0f;
+	for (uint32_t s = 1; s <= SEGMENT_SIDES; ++ s) {
+		ring_x[s] = ring_x[s - 1] * step_cos - ring_z[s - 1] * step_sin;
+		ring_z[s] = ring_x[s - 1] * step_sin + ring_z[s - 1] * step_cos;
+	}
+
+	for (uint32_t r = 0; r < SEGMENT_RINGS; ++ r) {
+		float v = float(r) / (SEGMENT_RINGS - 1);
+		float ring_radius = radius * (0.75f + 0.5f * random.unit());
+		for (uint32_t s = 0; s <= SEGMENT_SIDES; ++ s) {
+			segment.vertex.push_back({ ring_x[s] * ring_radius, v * height, ring_z[s] * ring_radius });
+			segment.tex_uv.push_back({ float(s) / SEGMENT_SIDES, v });
+			if (with_normals) {
+				segment.normal.push_back({ ring_x[s], 0.0f, ring_z[s] });
+			}
+		}
+	}
+
+	const uint16_t ring_vertices = SEGMENT_SIDES + 1;
+	for (uint32_t r = 0; r + 1 < SEGMENT_RINGS; ++ r) {
+		for (uint16_t s = 0; s <= SEGMENT_SIDES; ++ s) {
+			uint16_t upper = (r + 1) * ring_vertices + s;
+			uint16_t lower = r * ring_vertices + s;
+			if (s == 0) {
+				upper |= 0x8000;
+				lower |= 0x8000;
+			}
+			segment.strip.push_back(upper);
+			segment.strip.push_back(lower);
+		}
+	}
+}
+
+// Closed prisms of COLLISION_SIDES sides stacked along the bone chain, one
+// per bone with its own radius, so the mesh is concave
+static void generate_collision_mesh(SyntheticRandom &random, uint32_t bones, SyntheticModel &model) {
+	const float step_cos = 0.70710678f; // cos(2 pi / 8)
+	const float step_sin = 0.70710678f;
+	float ring_x[COLLISION_SIDES];
+	float ring_z[COLLISION_SIDES];
+	ring_x[0] = 1.0f;
+	ring_z[0] = 0.0f;
+	for (uint32_t s = 1; s < COLLISION_SIDES; ++ s) {
+		ring_x[s] = ring_x[s - 1] * step_cos - ring_z[s - 1] * step_sin;
+		ring_z[s] = ring_x[s - 1] * step_sin + ring_z[s - 1] * step_cos;
+	}
+
+	for (uint32_t b = 0; b < bones; ++ b) {
+		const float radius = 0.5f + random.unit();
+		const uint16_t bottom = model.collision_vertex.size();
+		const uint16_t top = bottom + COLLISION_SIDES;
+		for (uint32_t y = b; y <= b + 1; ++ y) {
+			for (uint32_t s = 0; s < COLLISION_SIDES; ++ s) {
+				model.collision_vertex.push_back({ ring_x[s] * radius, float(y), ring_z[s] * radius });
+			}
+		}
+		for (uint16_t s = 0; s < COLLISION_SIDES; ++ s) {
+			uint16_t next = (s + 1) % COLLISION_SIDES;
+			model.collision_index.insert(model.collision_index.end(), {
+				uint16_t(bottom + s), uint16_t(top + s), uint16_t(bottom + next),
+				uint16_t(bottom + next), uint16_t(top + s), uint16_t(top + next),
+			});
+		}
+		for (uint32_t s = 1; s + 1 < COLLISION_SIDES; ++ s) {
+			model.collision_index.insert(model.collision_index.end(), {
+				bottom, uint16_t(bottom + s + 1), uint16_t(bottom + s),
+				top, uint16_t(top + s), uint16_t(top + s + 1),
+			});
+		}
+	}
+}
+
+static void generate_model(const SyntheticWorldParams &params, SyntheticRandom &random, SyntheticModel &model) {
+	static const LibSWBF2::ECollisionPrimitiveType primitive_types[] = {
+		LibSWBF2::ECollisionPrimitiveType::Cube,
+		LibSWBF2::ECollisionPrimitiveType::Cylinder,
+		LibSWBF2::ECollisionPrimitiveType::Sphere,
+	};
+
+	model.bones.resize(params.bone_depth);
+	model.collision_primitives.resize(params.bone_depth);
+	for (uint32_t b = 0; b < params.bone_depth; ++ b) {
+		BoneView &bone = model.bones[b];
+		bone.name = "bone_" + itos(b);
+		bone.parent_name = b > 0 ? model.bones[b - 1].name : String();
+		bone.position = { 0.0f, b > 0 ? 1.0f : 0.0f, 0.0f };
+		bone.rotation = { 0.0f, 0.0f, 0.0f, 1.0f };
+
+		CollisionPrimitiveView &primitive = model.collision_primitives[b];
+		primitive.parent_name = bone.name;
+		primitive.type = primitive_types[random.below(3)];
+		for (float &dim : primitive.dims) {
+			dim = 0.25f + random.unit();
+		}
+		primitive.position = { 0.0f, 0.5f, 0.0f };
+		primitive.rotation = { 0.0f, 0.0f, 0.0f, 1.0f };
+	}
+
+	model.segments.resize(params.strip_segments);
+	for (uint32_t s = 0; s < params.strip_segments; ++ s) {
+		SyntheticSegment &segment = model.segments[s];
+		segment.bone = s % params.bone_depth;
+		segment.material = random.below(params.texture_count);
+		generate_segment(random, s & 1, segment);
+	}
+
+	generate_collision_mesh(random, params.bone_depth, model);
+}
+
+static void generate_entity_classes(const SyntheticWorldParams &params, SyntheticWorld &out) {
+	const String last_bone = "bone_" + itos(params.bone_depth - 1);
+	for (uint32_t e = 0; e < params.entity_classes; ++ e) {
+		SyntheticRandom random((uint64_t(params.seed) << 32) ^ (uint64_t(e) << 1) ^ 1);
+		String model_name = "synthetic_model_" + itos(e);
+		SyntheticModel model;
+		generate_model(params, random, model);
+		out.models.insert(model_name, model);
+
+		EntityClassView entity_class;
+		entity_class.base_name = "prop";
+		entity_class.properties.push_back({ fnv_hash("GeometryName"), model_name });
+		if (e % 4 == 0 && e + 1 < params.entity_classes) {
+			entity_class.properties.push_back({ fnv_hash("AttachODF"), entity_class_name(e + 1) });
+			entity_class.properties.push_back({ fnv_hash("AttachToHardpoint"), last_bone });
+		}
+		out.entity_classes.insert(entity_class_name(e), entity_class);
+	}
+}
+
+static void generate_instances(const SyntheticWorldParams &params, SyntheticWorld &out) {
+	const float extent = MAX(params.terrain_size, 1u) * TERRAIN_SPACING;
+	SyntheticRandom random((uint64_t(params.seed) << 32) ^ 0xFFFFFFFFULL);
+	out.instances.resize(params.instance_count);
+	for (size_t i = 0; i < out.instances.size(); ++ i) {
+		InstanceView &instance = out.instances[i];
+		instance.name = "instance_" + itos(i);
+		instance.entity_class_name = entity_class_name(random.below(params.entity_classes));
+		float x = random.unit() * extent;
+		float z = random.unit() * extent;
+		instance.position = { x, terrain_height(uint64_t(params.seed) << 8, x / TERRAIN_SPACING, z / TERRAIN_SPACING), z };
+		// A random rotation about Y, normalized rather than built with sin
+		// and cos
+		float s = random.unit() * 2.0f - 1.0f;
+		float c = random.unit() * 2.0f - 1.0f;
+		float length = std::sqrt(s * s + c * c);
+		if (length == 0.0f) {
+			s = 0.0f;
+			c = length = 1.0f;
+		}
+		instance.rotation = { 0.0f, s / length, 0.0f, c / length };
+	}
+}
+
+void generate_synthetic_world(const SyntheticWorldParams &params, SyntheticWorld &out) {
+	out = SyntheticWorld();
+	generate_terrain(params, out);
+	generate_blend_map(params, out);
+	generate_textures(params, out);
+	generate_materials(params, out);
+	generate_entity_classes(params, out);
+	generate_instances(params, out);
+}
+
+const SyntheticTexture *SyntheticWorld::find_texture(const String &name) const {
+	return textures.getptr(name);
+}
+
+bool SyntheticWorld::get_entity_class(const String &name, EntityClassView &out) const {
+	const EntityClassView *entity_class = entity_classes.getptr(name);
+	if (entity_class == nullptr) {
+		return false;
+	}
+	out = *entity_class;
+	return true;
+}
+
+bool SyntheticWorld::get_model(const String &name, ModelView &out) const {
+	const SyntheticModel *model = models.getptr(name);
+	if (model == nullptr) {
+		return false;
+	}
+	out.bones = model->bones;
+	out.segments.resize(model->segments.size());
+	for (size_t s = 0; s < model->segments.size(); ++ s) {
+		const SyntheticSegment &segment = model->segments[s];
+		SegmentView &view = out.segments[s];
+		view.bone_name = model->bones[segment.bone].name;
+		view.buffers = {
+			segment.vertex.data(), segment.vertex.size(),
+			segment.tex_uv.data(), segment.tex_uv.size(),
+			segment.normal.data(), segment.normal.size(),
+			segment.strip.data(), segment.strip.size(),
+			LibSWBF2::ETopology::TriangleStrip,
+		};
+		view.material = materials[segment.material];
+	}
+	out.collision_primitives = model->collision_primitives;
+	out.collision_vertex = model->collision_vertex.data();
+	out.collision_vertex_count = model->collision_vertex.size();
+	out.collision_index = model->collision_index.data();
+	out.collision_index_count = model->collision_index.size();
+	return true;
+}
+
+}
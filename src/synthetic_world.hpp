@@ -0,0 +1,110 @@
+#ifndef LVLIMPORT_SYNTHETIC_WORLD_HPP_
+#define LVLIMPORT_SYNTHETIC_WORLD_HPP_
+
+#include "level_view.hpp"
+#include <godot_cpp/templates/hash_map.hpp>
+#include <godot_cpp/variant/dictionary.hpp>
+#include <godot_cpp/variant/packed_byte_array.hpp>
+#include <godot_cpp/variant/string.hpp>
+#include <LibSWBF2/API.h>
+#include <cstdint>
+#include <vector>
+
+namespace godot {
+
+// Sizes of a generated world, read from the dictionary passed to
+// LVLImport.import_synthetic. Unknown keys are ignored and missing keys
+// keep their defaults.
+struct SyntheticWorldParams {
+	// "terrain_size": terrain quads per side, rounded up to whole 8 x 8
+	// quad patches. Like SWBF2 terrain each patch has its own copy of its
+	// border vertices.
+	uint32_t terrain_size = 256;
+
+	// "instance_count": instances scattered over the terrain
+	uint32_t instance_count = 1000;
+
+	// "entity_classes": unique entity classes the instances are drawn from
+	uint32_t entity_classes = 32;
+
+	// "texture_count" and "texture_resolution": square RGBA8 textures,
+	// each the albedo of one material
+	uint32_t texture_count = 16;
+	uint32_t texture_resolution = 256;
+
+	// "bone_depth": length of each entity class model's bone chain
+	uint32_t bone_depth = 4;
+
+	// "strip_segments": triangle strip segments per model, spread over its
+	// bones. Odd segments come with normals, even segments have
+	// theirs generated.
+	uint32_t strip_segments = 8;
+
+	// "seed": the same seed and sizes always generate the same world
+	uint32_t seed = 1;
+
+	static SyntheticWorldParams from_dictionary(const Dictionary &params);
+};
+
+// One mesh segment laid out as LibSWBF2 returns it, so it goes through the
+// same conversion as segments from a real level
+struct SyntheticSegment {
+	std::vector<LibSWBF2::Vector3> vertex;
+	std::vector<LibSWBF2::Vector3> normal; // Empty if normals must be generated
+	std::vector<LibSWBF2::Vector2> tex_uv;
+	std::vector<uint16_t> strip; // SWBF2 strips, see triangle_strip.hpp
+	uint32_t bone = 0;
+	uint32_t material = 0;
+};
+
+// A chain of bones, each with a collision primitive and some segments,
+// around a collision mesh of stacked prisms
+struct SyntheticModel {
+	std::vector<BoneView> bones;
+	std::vector<SyntheticSegment> segments;
+	std::vector<CollisionPrimitiveView> collision_primitives;
+	std::vector<LibSWBF2::Vector3> collision_vertex;
+	std::vector<uint16_t> collision_index;
+};
+
+struct SyntheticTexture {
+	uint32_t resolution = 0;
+	PackedByteArray pixels; // RGBA8
+};
+
+struct SyntheticWorld {
+	// Terrain buffers in the layout and winding LibSWBF2 returns them in
+	std::vector<LibSWBF2::Vector3> terrain_vertex;
+	std::vector<LibSWBF2::Vector2> terrain_tex_uv;
+	std::vector<uint32_t> terrain_index;
+	// Blend map as returned by Terrain_GetBlendMapT, blending the textures
+	// in terrain_layers
+	std::vector<uint8_t> blend_map;
+	uint32_t blend_map_dim = 0;
+	std::vector<String> terrain_layers;
+
+	HashMap<String, SyntheticTexture> textures;
+	// One material per albedo texture, as WorldImporter assumes. Some have
+	// normal maps and some are transparent.
+	std::vector<MaterialView> materials;
+	HashMap<String, SyntheticModel> models;
+	// Props using one model each. Every fourth attaches the next to the
+	// last bone of its model.
+	HashMap<String, EntityClassView> entity_classes;
+	std::vector<InstanceView> instances;
+
+	const SyntheticTexture *find_texture(const String &name) const;
+	bool get_entity_class(const String &name, EntityClassView &out) const;
+	// Points out's buffers into the model, so it is valid as long as the
+	// world is
+	bool get_model(const String &name, ModelView &out) const;
+};
+
+// Fills out with a world of the given sizes. The result depends only on
+// params, never on the platform or the time, so imports of it can be
+// compared from run to run and machine to machine.
+void generate_synthetic_world(const SyntheticWorldParams &params, SyntheticWorld &out);
+
+}
+
+#endif
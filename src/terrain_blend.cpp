@@ -0,0 +1,189 @@
+#include "terrain_blend.hpp"
+#include "worker_pool.hpp"
+#include <godot_cpp/core/defs.hpp>
+#include <godot_cpp/variant/color.hpp>
+#include <godot_cpp/variant/packed_byte_array.hpp>
+#include <godot_cpp/variant/typed_array.hpp>
+#include <cstring>
+
+namespace godot {
+
+void build_terrain_blend_maps(const uint8_t *blend, uint32_t dim, uint32_t layer_count, WorkerPool &pool, TerrainBlendMaps &out) {
+	layer_count = MIN(layer_count, TERRAIN_MAX_LAYERS);
+	if (blend == nullptr || dim == 0 || layer_count == 0) {
+		PackedByteArray index, weight;
+		index.resize(4);
+		weight.resize(4 * 4);
+		memset(index.ptrw(), 0, index.size());
+		memset(weight.ptrw(), 0, weight.size());
+		for (int corner = 0; corner < 4; ++ corner) {
+			weight.ptrw()[corner * 4] = 255;
+		}
+		out.layer_index = Image::create_from_data(1, 1, false, Image::Format::FORMAT_RGBA8, index);
+		out.layer_weight = Image::create_from_data(2, 2, false, Image::Format::FORMAT_RGBA8, weight);
+		return;
+	}
+
+	PackedByteArray index;
+	PackedByteArray weight;
+	index.resize(dim * dim * 4);
+	weight.resize(dim * dim * 16);
+	uint8_t *index_out = index.ptrw();
+	uint8_t *weight_out = weight.ptrw();
+	const uint32_t weight_stride = dim * 2 * 4;
+
+	pool.parallel_for(dim, [&](uint32_t, uint32_t begin, uint32_t end) {
+		for (uint32_t y = begin; y < end; ++ y) {
+		for (uint32_t x = 0; x < dim; ++ x) {
+			// Blend map texels at the cell's corners, clamped to the edge as
+			// a linear sampler would be
+			const uint32_t x1 = MIN(x + 1, dim - 1);
+			const uint32_t y1 = MIN(y + 1, dim - 1);
+			const uint8_t *corner[4] = {
+				blend + (y * dim + x) * layer_count,
+				blend + (y * dim + x1) * layer_count,
+				blend + (y1 * dim + x) * layer_count,
+				blend + (y1 * dim + x1) * layer_count,
+			};
+			uint32_t sum[TERRAIN_MAX_LAYERS];
+			for (uint32_t l = 0; l < layer_count; ++ l) {
+				sum[l] = corner[0][l] + corner[1][l] + corner[2][l] + corner[3][l];
+			}
+
+			// Heaviest layers first, lower indices winning ties
+			uint8_t top[TERRAIN_BLEND_TOP_K] = {};
+			uint32_t top_sum[TERRAIN_BLEND_TOP_K] = {};
+			for (uint32_t l = 0; l < layer_count; ++ l) {
+				for (uint32_t k = 0; k < TERRAIN_BLEND_TOP_K; ++ k) {
+					if (sum[l] > top_sum[k]) {
+						for (uint32_t m = TERRAIN_BLEND_TOP_K - 1; m > k; -- m) {
+							top[m] = top[m - 1];
+							top_sum[m] = top_sum[m - 1];
+						}
+						top[k] = l;
+						top_sum[k] = sum[l];
+						break;
+					}
+				}
+			}
+
+			uint8_t *cell_index = index_out + (y * dim + x) * 4;
+			for (uint32_t k = 0; k < TERRAIN_BLEND_TOP_K; ++ k) {
+				cell_index[k] = top_sum[k] ? top[k] : top[0];
+			}
+			for (uint32_t c = 0; c < 4; ++ c) {
+				// Scale the kept weights up to the corner's total weight so
+				// dropping layers doesn't darken it
+				uint32_t total = 0;
+				uint32_t kept = 0;
+				for (uint32_t l = 0; l < layer_count; ++ l) {
+					total += corner[c][l];
+				}
+				for (uint32_t k = 0; k < TERRAIN_BLEND_TOP_K; ++ k) {
+					kept += top_sum[k] ? corner[c][top[k]] : 0;
+				}
+				uint8_t *cell_weight = weight_out + (y * 2 + c / 2) * weight_stride + (x * 2 + c % 2) * 4;
+				for (uint32_t k = 0; k < TERRAIN_BLEND_TOP_K; ++ k) {
+					uint32_t w = top_sum[k] ? corner[c][top[k]] : 0;
+					cell_weight[k] = kept ? MIN((w * total + kept / 2) / kept, 255u) : 0;
+				}
+			}
+		}}
+	}, 16);
+
+	out.layer_index = Image::create_from_data(dim, dim, false, Image::Format::FORMAT_RGBA8, index);
+	out.layer_weight = Image::create_from_data(dim * 2, dim * 2, false, Image::Format::FORMAT_RGBA8, weight);
+}
+
+Ref<Texture2DArray> build_terrain_layer_array(const std::vector<Ref<Image>> &layers, TextureCompression compression) {
+	int32_t width = 0;
+	int32_t height = 0;
+	for (const Ref<Image> &layer : layers) {
+		if (layer.is_valid() && !layer->is_empty()) {
+			width = MAX(width, layer->get_width());
+			height = MAX(height, layer->get_height());
+		}
+	}
+	if (width == 0 || height == 0) {
+		return {};
+	}
+
+	TypedArray<Image> images;
+	for (const Ref<Image> &layer : layers) {
+		Ref<Image> image;
+		if (layer.is_valid() && !layer->is_empty()) {
+			image = layer->duplicate();
+			if (image->is_compressed()) {
+				image->decompress();
+			}
+			if (image->has_mipmaps()) {
+				image->clear_mipmaps();
+			}
+			image->convert(Image::FORMAT_RGB8);
+			if (image->get_width() != width || image->get_height() != height) {
+				image->resize(width, height, Image::INTERPOLATE_CUBIC);
+			}
+		} else {
+			image = Image::create_empty(width, height, false, Image::FORMAT_RGB8);
+			image->fill(Color(0.5, 0.5, 0.5));
+		}
+		// Alpha is unused, so every layer compresses to the same format
+		if (compression == TextureCompression::None) {
+			image->convert(Image::FORMAT_RGBA8);
+			image->generate_mipmaps();
+		} else if (compress_image(image, TextureUsage::Albedo, compression) != Error::OK) {
+			return build_terrain_layer_array(layers, TextureCompression::None);
+		}
+		images.push_back(image);
+	}
+
+	Ref<Texture2DArray> array;
+	array.instantiate();
+	if (array->create_from_images(images) != Error::OK) {
+		return {};
+	}
+	return array;
+}
+
+const char *const TERRAIN_SHADER_CODE = R"(shader_type spatial;
+
+// Generated by the lvl importer, see terrain_blend.hpp
+uniform sampler2DArray Layers : source_color, filter_linear_mipmap, repeat_enable;
+uniform sampler2D LayerIndex : filter_nearest;
+uniform sampler2D LayerWeight : filter_nearest;
+
+void fragment() {
+	ivec2 size = textureSize(LayerIndex, 0);
+	vec2 p = clamp(UV2 * vec2(size) - 0.5, vec2(0.0), vec2(size - 1));
+	ivec2 cell = min(ivec2(p), size - 1);
+	vec2 f = p - vec2(cell);
+
+	ivec4 layer = ivec4(round(texelFetch(LayerIndex, cell, 0) * 255.0));
+	ivec2 corner = cell * 2;
+	vec4 w00 = texelFetch(LayerWeight, corner, 0);
+	vec4 w10 = texelFetch(LayerWeight, corner + ivec2(1, 0), 0);
+	vec4 w01 = texelFetch(LayerWeight, corner + ivec2(0, 1), 0);
+	vec4 w11 = texelFetch(LayerWeight, corner + ivec2(1, 1), 0);
+	vec4 w = mix(mix(w00, w10, f.x), mix(w01, w11, f.x), f.y);
+
+	// Gradients are taken up front since the layer fetches are branched
+	vec2 uv_dx = dFdx(UV);
+	vec2 uv_dy = dFdy(UV);
+	vec3 albedo = textureGrad(Layers, vec3(UV, float(layer.x)), uv_dx, uv_dy).rgb * w.x;
+	if (w.y > 0.0) {
+		albedo += textureGrad(Layers, vec3(UV, float(layer.y)), uv_dx, uv_dy).rgb * w.y;
+	}
+	if (w.z > 0.0) {
+		albedo += textureGrad(Layers, vec3(UV, float(layer.z)), uv_dx, uv_dy).rgb * w.z;
+	}
+	if (w.w > 0.0) {
+		albedo += textureGrad(Layers, vec3(UV, float(layer.w)), uv_dx, uv_dy).rgb * w.w;
+	}
+
+	ALBEDO = albedo;
+	SPECULAR = 0.0f;
+	METALLIC = 0.0f;
+}
+)";
+
+}
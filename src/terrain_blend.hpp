@@ -0,0 +1,52 @@
+#ifndef LVLIMPORT_TERRAIN_BLEND_HPP_
+#define LVLIMPORT_TERRAIN_BLEND_HPP_
+
+#include "texture_stage.hpp"
+#include <godot_cpp/classes/image.hpp>
+#include <godot_cpp/classes/texture2d_array.hpp>
+#include <cstdint>
+#include <vector>
+
+namespace godot {
+
+class WorkerPool;
+
+// SWBF2 terrain blends at most 16 layers
+constexpr uint32_t TERRAIN_MAX_LAYERS = 16;
+
+// Layers blended per blend map cell by TERRAIN_SHADER_CODE
+constexpr uint32_t TERRAIN_BLEND_TOP_K = 4;
+
+// Sparse form of a terrain blend map. Each cell lies between four blend
+// map texels, which are its bilinear footprint:
+// - layer_index holds the indices of the cell's four most heavily weighted
+//   layers, summed over its footprint, one per channel
+// - layer_weight holds a 2 x 2 block per cell with the weight of each of
+//   those layers at each of the footprint's texels
+// Blending is exact wherever a cell has four or fewer layers. Otherwise the
+// lightest layers are dropped and the rest scaled up to the same total.
+struct TerrainBlendMaps {
+	Ref<Image> layer_index;  // dim x dim RGBA8
+	Ref<Image> layer_weight; // 2 dim x 2 dim RGBA8
+};
+
+// blend holds dim x dim texels of layer_count weights each, as returned by
+// Terrain_GetBlendMapT. Without a blend map every cell is layer 0.
+void build_terrain_blend_maps(const uint8_t *blend, uint32_t dim, uint32_t layer_count, WorkerPool &pool, TerrainBlendMaps &out);
+
+// Packs layer images into one array so the shader samples only the layers
+// each fragment uses. Layers are converted to a common size and format,
+// mipmapped and compressed as albedo. Null layers become flat grey so
+// layer indices stay aligned with the blend map. Returns null if every
+// layer is null.
+Ref<Texture2DArray> build_terrain_layer_array(const std::vector<Ref<Image>> &layers, TextureCompression compression);
+
+// Shader for materials using the maps above: "LayerIndex", "LayerWeight"
+// and the "Layers" array. Takes 5 small unfiltered fetches and one layer
+// fetch per contributing layer, rather than sampling all 4 blend maps and
+// 16 layers.
+extern const char *const TERRAIN_SHADER_CODE;
+
+}
+
+#endif
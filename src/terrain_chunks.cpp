@@ -0,0 +1,211 @@
+#include "terrain_chunks.hpp"
+#include "worker_pool.hpp"
+#include <godot_cpp/core/defs.hpp>
+#include <godot_cpp/templates/hash_map.hpp>
+#include <cmath>
+#include <cstring>
+#include <float.h>
+
+namespace godot {
+
+static inline uint64_t cluster_key(int64_t x, int64_t z) {
+	return (static_cast<uint64_t>(x) << 32) ^ (static_cast<uint64_t>(z) & 0xFFFFFFFF);
+}
+
+void split_terrain_mesh(const TerrainMesh &mesh, uint32_t chunks_per_side, uint32_t lod_levels, WorkerPool &pool, std::vector<TerrainChunk> &out) {
+	constexpr uint32_t NONE = UINT32_MAX;
+	const uint32_t n = MAX(chunks_per_side, 1u);
+	const uint32_t vertex_count = mesh.vertex.size();
+	const uint32_t triangle_count = mesh.index.size() / 3;
+	const Vector3 *vertex = mesh.vertex.ptr();
+	const int32_t *index = mesh.index.ptr();
+	const bool has_tex_uv = mesh.tex_uv.size() == vertex_count;
+
+	out.clear();
+	if (triangle_count == 0) {
+		return;
+	}
+
+	// Welding leaves many vertices unreferenced, ignore them entirely
+	std::vector<uint8_t> referenced(vertex_count, 0);
+	uint32_t referenced_count = 0;
+	float minx = FLT_MAX, minz = FLT_MAX;
+	float maxx = -FLT_MAX, maxz = -FLT_MAX;
+	for (uint32_t i = 0; i < triangle_count * 3; ++ i) {
+		uint32_t v = index[i];
+		if (referenced[v]) {
+			continue;
+		}
+		referenced[v] = 1;
+		referenced_count += 1;
+		minx = MIN(minx, vertex[v].x);
+		minz = MIN(minz, vertex[v].z);
+		maxx = MAX(maxx, vertex[v].x);
+		maxz = MAX(maxz, vertex[v].z);
+	}
+	const float size_x = MAX(maxx - minx, 1e-6f);
+	const float size_z = MAX(maxz - minz, 1e-6f);
+
+	// Bucket triangles by centroid, keeping their order within each chunk
+	std::vector<uint32_t> triangle_chunk(triangle_count);
+	pool.parallel_for(triangle_count, [&](uint32_t, uint32_t begin, uint32_t end) {
+		for (uint32_t t = begin; t < end; ++ t) {
+			const int32_t *tri = index + t * 3;
+			float cx = (vertex[tri[0]].x + vertex[tri[1]].x + vertex[tri[2]].x) / 3.0f;
+			float cz = (vertex[tri[0]].z + vertex[tri[1]].z + vertex[tri[2]].z) / 3.0f;
+			int64_t gx = static_cast<int64_t>((cx - minx) / size_x * n);
+			int64_t gz = static_cast<int64_t>((cz - minz) / size_z * n);
+			gx = CLAMP(gx, int64_t(0), int64_t(n - 1));
+			gz = CLAMP(gz, int64_t(0), int64_t(n - 1));
+			triangle_chunk[t] = gz * n + gx;
+		}
+	});
+	std::vector<uint32_t> chunk_offset(n * n + 1, 0);
+	for (uint32_t t = 0; t < triangle_count; ++ t) {
+		chunk_offset[triangle_chunk[t] + 1] += 1;
+	}
+	for (uint32_t c = 0; c < n * n; ++ c) {
+		chunk_offset[c + 1] += chunk_offset[c];
+	}
+	std::vector<uint32_t> chunk_triangles(triangle_count);
+	{
+		std::vector<uint32_t> cursor(chunk_offset.begin(), chunk_offset.end() - 1);
+		for (uint32_t t = 0; t < triangle_count; ++ t) {
+			chunk_triangles[cursor[triangle_chunk[t]]++] = t;
+		}
+	}
+
+	// Cluster vertices for each LOD level. Every vertex collapses onto the
+	// vertex of its cluster nearest the cluster's centre on the XZ plane.
+	const float spacing = MAX(std::sqrt(size_x * size_z / MAX(referenced_count, 1u)), 1e-3f);
+	std::vector<std::vector<uint32_t>> lod_remap(lod_levels);
+	std::vector<float> lod_edge_length(lod_levels);
+	pool.run(lod_levels, [&](uint32_t level) {
+		const float cell = spacing * float(2 << level);
+		lod_edge_length[level] = cell;
+		HashMap<uint64_t, uint32_t> nearest;
+		std::vector<uint64_t> vertex_cluster(vertex_count, 0);
+		auto centre_distance = [&](uint32_t v, int64_t kx, int64_t kz) {
+			float dx = vertex[v].x - (minx + (kx + 0.5f) * cell);
+			float dz = vertex[v].z - (minz + (kz + 0.5f) * cell);
+			return dx * dx + dz * dz;
+		};
+		for (uint32_t v = 0; v < vertex_count; ++ v) {
+			if (!referenced[v]) {
+				continue;
+			}
+			int64_t kx = static_cast<int64_t>(std::floor((vertex[v].x - minx) / cell));
+			int64_t kz = static_cast<int64_t>(std::floor((vertex[v].z - minz) / cell));
+			uint64_t key = cluster_key(kx, kz);
+			vertex_cluster[v] = key;
+			if (uint32_t *best = nearest.getptr(key)) {
+				if (centre_distance(v, kx, kz) < centre_distance(*best, kx, kz)) {
+					*best = v;
+				}
+			} else {
+				nearest.insert(key, v);
+			}
+		}
+		std::vector<uint32_t> &remap = lod_remap[level];
+		remap.assign(vertex_count, NONE);
+		for (uint32_t v = 0; v < vertex_count; ++ v) {
+			if (referenced[v]) {
+				remap[v] = nearest.get(vertex_cluster[v]);
+			}
+		}
+	});
+
+	std::vector<TerrainChunk> chunks(n * n);
+	pool.run(n * n, [&](uint32_t c) {
+		const uint32_t begin = chunk_offset[c];
+		const uint32_t end = chunk_offset[c + 1];
+		if (begin == end) {
+			return;
+		}
+		TerrainChunk &chunk = chunks[c];
+		chunk.x = c % n;
+		chunk.z = c / n;
+
+		HashMap<uint32_t, uint32_t> local_index;
+		std::vector<uint32_t> global_index;
+		auto to_local = [&](uint32_t v) -> int32_t {
+			if (const uint32_t *l = local_index.getptr(v)) {
+				return *l;
+			}
+			uint32_t l = global_index.size();
+			global_index.push_back(v);
+			local_index.insert(v, l);
+			return l;
+		};
+
+		chunk.index.resize((end - begin) * 3);
+		int32_t *chunk_index = chunk.index.ptrw();
+		for (uint32_t i = begin; i < end; ++ i) {
+			const int32_t *tri = index + chunk_triangles[i] * 3;
+			for (int j = 0; j < 3; ++ j) {
+				*chunk_index++ = to_local(tri[j]);
+			}
+		}
+
+		uint32_t previous_triangles = end - begin;
+		std::vector<int32_t> lod_index;
+		for (uint32_t level = 0; level < lod_levels; ++ level) {
+			const std::vector<uint32_t> &remap = lod_remap[level];
+			lod_index.clear();
+			for (uint32_t i = begin; i < end; ++ i) {
+				const int32_t *tri = index + chunk_triangles[i] * 3;
+				uint32_t v0 = remap[tri[0]];
+				uint32_t v1 = remap[tri[1]];
+				uint32_t v2 = remap[tri[2]];
+				if (v0 == v1 || v1 == v2 || v0 == v2) {
+					continue; // Collapsed
+				}
+				lod_index.push_back(to_local(v0));
+				lod_index.push_back(to_local(v1));
+				lod_index.push_back(to_local(v2));
+			}
+			// Stop once a level no longer simplifies or collapses entirely
+			uint32_t lod_triangles = lod_index.size() / 3;
+			if (lod_triangles == 0 || lod_triangles >= previous_triangles) {
+				break;
+			}
+			previous_triangles = lod_triangles;
+			TerrainChunkLOD lod;
+			lod.edge_length = lod_edge_length[level];
+			lod.index.resize(lod_index.size());
+			memcpy(lod.index.ptrw(), lod_index.data(), lod_index.size() * sizeof(int32_t));
+			chunk.lods.push_back(lod);
+		}
+
+		const Vector3 *normal = mesh.normal.ptr();
+		const Vector2 *blend_uv = mesh.blend_uv.ptr();
+		const Vector2 *tex_uv = mesh.tex_uv.ptr();
+		const uint32_t chunk_vertex_count = global_index.size();
+		chunk.vertex.resize(chunk_vertex_count);
+		chunk.normal.resize(chunk_vertex_count);
+		chunk.blend_uv.resize(chunk_vertex_count);
+		Vector3 *chunk_vertex = chunk.vertex.ptrw();
+		Vector3 *chunk_normal = chunk.normal.ptrw();
+		Vector2 *chunk_blend_uv = chunk.blend_uv.ptrw();
+		for (uint32_t l = 0; l < chunk_vertex_count; ++ l) {
+			chunk_vertex[l] = vertex[global_index[l]];
+			chunk_normal[l] = normal[global_index[l]];
+			chunk_blend_uv[l] = blend_uv[global_index[l]];
+		}
+		if (has_tex_uv) {
+			chunk.tex_uv.resize(chunk_vertex_count);
+			Vector2 *chunk_tex_uv = chunk.tex_uv.ptrw();
+			for (uint32_t l = 0; l < chunk_vertex_count; ++ l) {
+				chunk_tex_uv[l] = tex_uv[global_index[l]];
+			}
+		}
+	});
+
+	for (TerrainChunk &chunk : chunks) {
+		if (!chunk.index.is_empty()) {
+			out.push_back(std::move(chunk));
+		}
+	}
+}
+
+}
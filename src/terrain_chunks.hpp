@@ -0,0 +1,37 @@
+#ifndef LVLIMPORT_TERRAIN_CHUNKS_HPP_
+#define LVLIMPORT_TERRAIN_CHUNKS_HPP_
+
+#include "terrain_mesh.hpp"
+#include <vector>
+
+namespace godot {
+
+class WorkerPool;
+
+struct TerrainChunkLOD {
+	float edge_length; // Passed to ArrayMesh as the LOD's distance key
+	PackedInt32Array index;
+};
+
+struct TerrainChunk {
+	uint32_t x = 0;
+	uint32_t z = 0;
+	PackedVector3Array vertex;
+	PackedVector3Array normal;
+	PackedVector2Array tex_uv;
+	PackedVector2Array blend_uv;
+	PackedInt32Array index;
+	std::vector<TerrainChunkLOD> lods; // Increasingly coarse
+};
+
+// Splits a terrain mesh into a grid of chunks_per_side x chunks_per_side
+// chunks by triangle centroid, each with its own compacted vertex arrays.
+// Empty chunks are omitted. Each chunk also gets lod_levels coarser index
+// buffers made by clustering vertices on a terrain wide grid which doubles
+// in size every level. Clusters are shared by all chunks so LODs of
+// neighbouring chunks meet without cracks.
+void split_terrain_mesh(const TerrainMesh &mesh, uint32_t chunks_per_side, uint32_t lod_levels, WorkerPool &pool, std::vector<TerrainChunk> &out);
+
+}
+
+#endif
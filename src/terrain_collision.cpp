@@ -0,0 +1,174 @@
+#include "terrain_collision.hpp"
+#include "worker_pool.hpp"
+#include <godot_cpp/core/defs.hpp>
+#include <cmath>
+#include <float.h>
+
+namespace godot {
+
+float estimate_terrain_spacing(const TerrainMesh &mesh) {
+	const uint32_t vertex_count = mesh.vertex.size();
+	const int32_t *index = mesh.index.ptr();
+	const Vector3 *vertex = mesh.vertex.ptr();
+	std::vector<uint8_t> referenced(vertex_count, 0);
+	uint32_t referenced_count = 0;
+	float minx = FLT_MAX, minz = FLT_MAX;
+	float maxx = -FLT_MAX, maxz = -FLT_MAX;
+	for (int64_t i = 0; i < mesh.index.size(); ++ i) {
+		uint32_t v = index[i];
+		if (referenced[v]) {
+			continue;
+		}
+		referenced[v] = 1;
+		referenced_count += 1;
+		minx = MIN(minx, vertex[v].x);
+		minz = MIN(minz, vertex[v].z);
+		maxx = MAX(maxx, vertex[v].x);
+		maxz = MAX(maxz, vertex[v].z);
+	}
+	if (referenced_count < 4) {
+		return 1.0f;
+	}
+	// A w x d rectangle holding a regular grid of n points spaced s apart
+	// has (w / s + 1)(d / s + 1) = n, solved here for s
+	const double w = maxx - minx;
+	const double d = maxz - minz;
+	const double n = referenced_count - 1;
+	const double spacing = ((w + d) + std::sqrt((w + d) * (w + d) + 4.0 * n * w * d)) / (2.0 * n);
+	return MAX(static_cast<float>(spacing), 1e-3f);
+}
+
+void build_terrain_height_grid(const TerrainMesh &mesh, float spacing, WorkerPool &pool, TerrainHeightGrid &out) {
+	const uint32_t triangle_count = mesh.index.size() / 3;
+	const int32_t *index = mesh.index.ptr();
+	const Vector3 *vertex = mesh.vertex.ptr();
+
+	out = TerrainHeightGrid();
+	out.spacing = spacing;
+	if (triangle_count == 0 || !(spacing > 0.0f)) {
+		return;
+	}
+
+	float minx = FLT_MAX, minz = FLT_MAX, miny = FLT_MAX;
+	float maxx = -FLT_MAX, maxz = -FLT_MAX;
+	for (uint32_t i = 0; i < triangle_count * 3; ++ i) {
+		const Vector3 &v = vertex[index[i]];
+		minx = MIN(minx, v.x);
+		miny = MIN(miny, v.y);
+		minz = MIN(minz, v.z);
+		maxx = MAX(maxx, v.x);
+		maxz = MAX(maxz, v.z);
+	}
+	out.min_x = minx;
+	out.min_z = minz;
+	out.width = static_cast<uint32_t>(std::ceil((maxx - minx) / spacing)) + 1;
+	out.depth = static_cast<uint32_t>(std::ceil((maxz - minz) / spacing)) + 1;
+	out.height.assign(static_cast<size_t>(out.width) * out.depth, -FLT_MAX);
+	const uint32_t width = out.width;
+	const uint32_t depth = out.depth;
+	float *height = out.height.data();
+
+	auto first_point = [&](float p, float origin) {
+		return static_cast<int64_t>(std::ceil((p - origin) / spacing));
+	};
+	auto last_point = [&](float p, float origin) {
+		return static_cast<int64_t>(std::floor((p - origin) / spacing));
+	};
+
+	// Bucket triangles by the bands of rows they cross
+	const uint32_t bands = pool.chunk_count(depth, 8);
+	auto band_of_row = [&](uint32_t row) {
+		return static_cast<uint32_t>((static_cast<uint64_t>(row + 1) * bands - 1) / depth);
+	};
+	std::vector<uint32_t> band_offset(bands + 1, 0);
+	std::vector<uint32_t> band_triangles;
+	for (int pass = 0; pass < 2; ++ pass) {
+		std::vector<uint32_t> cursor(band_offset.begin(), band_offset.end() - 1);
+		for (uint32_t t = 0; t < triangle_count; ++ t) {
+			const int32_t *tri = index + t * 3;
+			float tri_minz = MIN(vertex[tri[0]].z, MIN(vertex[tri[1]].z, vertex[tri[2]].z));
+			float tri_maxz = MAX(vertex[tri[0]].z, MAX(vertex[tri[1]].z, vertex[tri[2]].z));
+			int64_t z0 = MAX(first_point(tri_minz, minz), int64_t(0));
+			int64_t z1 = MIN(last_point(tri_maxz, minz), int64_t(depth) - 1);
+			if (z0 > z1) {
+				continue;
+			}
+			for (uint32_t band = band_of_row(z0); band <= band_of_row(z1); ++ band) {
+				if (pass == 0) {
+					band_offset[band + 1] += 1;
+				} else {
+					band_triangles[cursor[band]++] = t;
+				}
+			}
+		}
+		if (pass == 0) {
+			for (uint32_t band = 0; band < bands; ++ band) {
+				band_offset[band + 1] += band_offset[band];
+			}
+			band_triangles.resize(band_offset[bands]);
+		}
+	}
+
+	pool.run(bands, [&](uint32_t band) {
+		uint32_t row_begin, row_end;
+		WorkerPool::chunk_range(depth, bands, band, row_begin, row_end);
+		for (uint32_t i = band_offset[band]; i < band_offset[band + 1]; ++ i) {
+			const int32_t *tri = index + band_triangles[i] * 3;
+			const Vector3 &a = vertex[tri[0]];
+			const Vector3 &b = vertex[tri[1]];
+			const Vector3 &c = vertex[tri[2]];
+			// Barycentric coordinates in the XZ plane. Vertical triangles
+			// have no area there and never cover a point.
+			float det = (b.z - c.z) * (a.x - c.x) + (c.x - b.x) * (a.z - c.z);
+			if (std::abs(det) < 1e-12f) {
+				continue;
+			}
+			float inv_det = 1.0f / det;
+			int64_t x0 = MAX(first_point(MIN(a.x, MIN(b.x, c.x)), minx), int64_t(0));
+			int64_t x1 = MIN(last_point(MAX(a.x, MAX(b.x, c.x)), minx), int64_t(width) - 1);
+			int64_t z0 = MAX(first_point(MIN(a.z, MIN(b.z, c.z)), minz), int64_t(row_begin));
+			int64_t z1 = MIN(last_point(MAX(a.z, MAX(b.z, c.z)), minz), int64_t(row_end) - 1);
+			for (int64_t z = z0; z <= z1; ++ z) {
+				float pz = minz + z * spacing;
+				for (int64_t x = x0; x <= x1; ++ x) {
+					float px = minx + x * spacing;
+					float wa = ((b.z - c.z) * (px - c.x) + (c.x - b.x) * (pz - c.z)) * inv_det;
+					float wb = ((c.z - a.z) * (px - c.x) + (a.x - c.x) * (pz - c.z)) * inv_det;
+					float wc = 1.0f - wa - wb;
+					if (wa < -1e-5f || wb < -1e-5f || wc < -1e-5f) {
+						continue;
+					}
+					float h = wa * a.y + wb * b.y + wc * c.y;
+					float &point = height[z * width + x];
+					point = MAX(point, h);
+				}
+			}
+		}
+	});
+
+	for (float &h : out.height) {
+		if (h == -FLT_MAX) {
+			h = miny;
+		}
+	}
+}
+
+void get_height_grid_tile(const TerrainHeightGrid &grid, uint32_t tiles, uint32_t tile_x, uint32_t tile_z,
+                          uint32_t &x0, uint32_t &z0, uint32_t &width, uint32_t &depth, PackedFloat32Array &height) {
+	// Split the grid's quads between tiles, then include the far edge
+	uint32_t x1, z1;
+	WorkerPool::chunk_range(grid.width - 1, tiles, tile_x, x0, x1);
+	WorkerPool::chunk_range(grid.depth - 1, tiles, tile_z, z0, z1);
+	width = x1 - x0 + 1;
+	depth = z1 - z0 + 1;
+	height.resize(width * depth);
+	float *out = height.ptrw();
+	for (uint32_t z = 0; z < depth; ++ z) {
+		const float *row = grid.height.data() + static_cast<size_t>(z0 + z) * grid.width + x0;
+		for (uint32_t x = 0; x < width; ++ x) {
+			*out++ = row[x];
+		}
+	}
+}
+
+}
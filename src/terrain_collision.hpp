@@ -0,0 +1,43 @@
+#ifndef LVLIMPORT_TERRAIN_COLLISION_HPP_
+#define LVLIMPORT_TERRAIN_COLLISION_HPP_
+
+#include "terrain_mesh.hpp"
+#include <godot_cpp/variant/packed_float32_array.hpp>
+#include <cstdint>
+#include <vector>
+
+namespace godot {
+
+class WorkerPool;
+
+// Terrain heights sampled on a regular grid over the terrain's bounds
+struct TerrainHeightGrid {
+	uint32_t width = 0; // Points along X
+	uint32_t depth = 0; // Points along Z
+	float spacing = 1;
+	float min_x = 0;
+	float min_z = 0;
+	std::vector<float> height; // depth rows of width points
+};
+
+// Average distance between neighbouring terrain vertices, assuming they
+// lie on a roughly regular grid as SWBF2 terrain does
+float estimate_terrain_spacing(const TerrainMesh &mesh);
+
+// Rasterizes the terrain's triangles onto a grid of the given spacing in
+// the XZ plane, taking the highest surface at each point where triangles
+// overlap. Points no triangle covers get the lowest terrain height. Rows
+// are split into bands across the pool, each rasterizing only the
+// triangles crossing it, and the result is the same for any number of
+// threads.
+void build_terrain_height_grid(const TerrainMesh &mesh, float spacing, WorkerPool &pool, TerrainHeightGrid &out);
+
+// The points of tile (tile_x, tile_z) of a tiles x tiles split of grid.
+// Neighbouring tiles share their border points so there are no gaps
+// between them. Fills the tile's first point and size in grid points.
+void get_height_grid_tile(const TerrainHeightGrid &grid, uint32_t tiles, uint32_t tile_x, uint32_t tile_z,
+                          uint32_t &x0, uint32_t &z0, uint32_t &width, uint32_t &depth, PackedFloat32Array &height);
+
+}
+
+#endif
@@ -0,0 +1,123 @@
+#include "terrain_mesh.hpp"
+#include "normal_kernel.hpp"
+#include "packed_convert.hpp"
+#include "worker_pool.hpp"
+#include <godot_cpp/core/defs.hpp>
+#include <algorithm>
+#include <float.h>
+#include <vector>
+
+namespace godot {
+
+void build_terrain_mesh(const LibSWBF2::Vector3 *vertices, uint32_t vertex_count,
+                        const LibSWBF2::Vector2 *tex_uvs, uint32_t tex_uv_count,
+                        uint32_t *indices, uint32_t index_count,
+                        WorkerPool &pool, TerrainMesh &out) {
+	out.vertex.resize(vertex_count);
+	out.blend_uv.resize(vertex_count);
+	copy_to_packed(tex_uvs, tex_uv_count, out.tex_uv);
+
+	Vector3 *vertex = out.vertex.ptrw();
+	Vector2 *blend_uv = out.blend_uv.ptrw();
+
+	// Copy vertices and find the horizontal bounds of the terrain
+	struct Bounds {
+		float minx = FLT_MAX;
+		float minz = FLT_MAX;
+		float maxx = FLT_MIN;
+		float maxz = FLT_MIN;
+	};
+	std::vector<Bounds> chunk_bounds(pool.chunk_count(vertex_count));
+	pool.run(chunk_bounds.size(), [&](uint32_t chunk) {
+		uint32_t begin, end;
+		WorkerPool::chunk_range(vertex_count, chunk_bounds.size(), chunk, begin, end);
+		Bounds &b = chunk_bounds[chunk];
+		for (uint32_t i = begin; i < end; ++ i) {
+			const LibSWBF2::Vector3 &zzz = vertices[i];
+			vertex[i] = Vector3(zzz.m_X, zzz.m_Y, zzz.m_Z);
+			b.minx = MIN(b.minx, zzz.m_X);
+			b.minz = MIN(b.minz, zzz.m_Z);
+			b.maxx = MAX(b.maxx, zzz.m_X);
+			b.maxz = MAX(b.maxz, zzz.m_Z);
+		}
+	});
+	Bounds bounds;
+	for (const Bounds &b : chunk_bounds) {
+		bounds.minx = MIN(bounds.minx, b.minx);
+		bounds.minz = MIN(bounds.minz, b.minz);
+		bounds.maxx = MAX(bounds.maxx, b.maxx);
+		bounds.maxz = MAX(bounds.maxz, b.maxz);
+	}
+
+	pool.parallel_for(vertex_count, [&](uint32_t, uint32_t begin, uint32_t end) {
+		for (uint32_t i = begin; i < end; ++ i) {
+			const LibSWBF2::Vector3 &zzz = vertices[i];
+			blend_uv[i] = Vector2((zzz.m_X - bounds.minx) / (bounds.maxx - bounds.minx), (zzz.m_Z - bounds.minz) / (bounds.maxz - bounds.minz));
+		}
+	});
+
+	// Terrain patches duplicate their border vertices, so weld every index
+	// onto an earlier vertex within 0.1 units of it. If we don't do this
+	// we can't calculate normals correctly.
+	out.weld = weld_indices(vertex, vertex_count, indices, index_count, 0.1f, pool);
+	out.index_errors = out.weld.index_errors;
+	out.first_bad_index = out.weld.first_bad_index;
+
+	// Count the triangles we keep in each chunk so every chunk knows where
+	// its output begins
+	const uint32_t triangle_count = index_count / 3;
+	const uint32_t triangle_chunks = pool.chunk_count(triangle_count);
+	std::vector<uint32_t> chunk_triangles(triangle_chunks, 0);
+	std::vector<uint32_t> chunk_first_bad(triangle_chunks, UINT32_MAX);
+	pool.run(triangle_chunks, [&](uint32_t chunk) {
+		uint32_t begin, end;
+		WorkerPool::chunk_range(triangle_count, triangle_chunks, chunk, begin, end);
+		for (uint32_t t = begin; t < end; ++ t) {
+			const uint32_t *tri = indices + t * 3;
+			uint32_t max_v = std::max(tri[0], std::max(tri[1], tri[2]));
+			if (max_v >= vertex_count) {
+				if (chunk_first_bad[chunk] == UINT32_MAX) {
+					chunk_first_bad[chunk] = max_v;
+				}
+				continue;
+			}
+			chunk_triangles[chunk] += 1;
+		}
+	});
+	std::vector<uint32_t> chunk_offset(triangle_chunks, 0);
+	uint32_t kept_triangles = 0;
+	for (uint32_t chunk = 0; chunk < triangle_chunks; ++ chunk) {
+		chunk_offset[chunk] = kept_triangles;
+		kept_triangles += chunk_triangles[chunk];
+		if (!out.index_errors && chunk_first_bad[chunk] != UINT32_MAX) {
+			out.index_errors = true;
+			out.first_bad_index = chunk_first_bad[chunk];
+		}
+	}
+
+	// Emit triangles. Note the reversed index orders
+	out.index.resize(kept_triangles * 3);
+	int32_t *index = out.index.ptrw();
+	pool.run(triangle_chunks, [&](uint32_t chunk) {
+		uint32_t begin, end;
+		WorkerPool::chunk_range(triangle_count, triangle_chunks, chunk, begin, end);
+		uint32_t o = chunk_offset[chunk];
+		for (uint32_t t = begin; t < end; ++ t) {
+			const uint32_t *tri = indices + t * 3;
+			uint32_t v0 = tri[2];
+			uint32_t v1 = tri[1];
+			uint32_t v2 = tri[0];
+			if (std::max(v0, std::max(v1, v2)) >= vertex_count) {
+				continue;
+			}
+			index[o * 3 + 0] = v0;
+			index[o * 3 + 1] = v1;
+			index[o * 3 + 2] = v2;
+			o += 1;
+		}
+	});
+
+	generate_vertex_normals(out.vertex, out.index, pool, out.normal);
+}
+
+}
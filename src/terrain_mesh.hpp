@@ -0,0 +1,37 @@
+#ifndef LVLIMPORT_TERRAIN_MESH_HPP_
+#define LVLIMPORT_TERRAIN_MESH_HPP_
+
+#include "vertex_weld.hpp"
+#include <godot_cpp/variant/packed_int32_array.hpp>
+#include <godot_cpp/variant/packed_vector2_array.hpp>
+#include <godot_cpp/variant/packed_vector3_array.hpp>
+#include <LibSWBF2/API.h>
+
+namespace godot {
+
+class WorkerPool;
+
+struct TerrainMesh {
+	PackedVector3Array vertex;
+	PackedVector3Array normal;
+	PackedVector2Array tex_uv;
+	PackedVector2Array blend_uv;
+	PackedInt32Array index;
+	WeldResult weld;
+	bool index_errors = false;
+	uint32_t first_bad_index = 0;
+};
+
+// Converts LibSWBF2 terrain buffers into Godot mesh arrays: welds the index
+// buffer in place, flips the winding, generates blend map UVs spanning the
+// terrain bounds and calculates smooth vertex normals. Every pass is split
+// into chunks across the pool and the result is identical for any number of
+// threads.
+void build_terrain_mesh(const LibSWBF2::Vector3 *vertices, uint32_t vertex_count,
+                        const LibSWBF2::Vector2 *tex_uvs, uint32_t tex_uv_count,
+                        uint32_t *indices, uint32_t index_count,
+                        WorkerPool &pool, TerrainMesh &out);
+
+}
+
+#endif
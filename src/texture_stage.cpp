@@ -0,0 +1,92 @@
+#include "texture_stage.hpp"
+#include "import_cache.hpp"
+#include "worker_pool.hpp"
+#include <godot_cpp/variant/packed_byte_array.hpp>
+#include <chrono>
+#include <cstring>
+
+using namespace LibSWBF2;
+
+namespace godot {
+
+Error compress_image(const Ref<Image> &image, TextureUsage usage, TextureCompression compression) {
+	Image::CompressSource source = Image::COMPRESS_SOURCE_SRGB;
+	if (usage == TextureUsage::NormalMap) {
+		source = Image::COMPRESS_SOURCE_NORMAL;
+	} else {
+		Image::AlphaMode alpha = image->detect_alpha();
+		bool keep_alpha = alpha == Image::ALPHA_BIT || (alpha == Image::ALPHA_BLEND && usage == TextureUsage::TransparentAlbedo);
+		if (!keep_alpha) {
+			image->convert(Image::FORMAT_RGB8);
+		}
+	}
+
+	if (Error err = image->generate_mipmaps(usage == TextureUsage::NormalMap)) {
+		return err;
+	}
+
+	Error err = Error::ERR_UNAVAILABLE;
+	if (compression == TextureCompression::S3TC) {
+		err = image->compress(Image::COMPRESS_S3TC, source);
+	}
+	if (err != Error::OK) {
+		err = image->compress(Image::COMPRESS_ETC2, source);
+	}
+	return err;
+}
+
+static void decode_texture_data(TextureJob &job, const uint8_t *data, uint16_t width, uint16_t height) {
+	if (width == 0 || height == 0) {
+		return;
+	}
+
+	size_t size = width * height * sizeof(uint8_t) * 4;
+
+	ContentHasher hasher;
+	hasher.add(width);
+	hasher.add(height);
+	hasher.add(job.usage);
+	hasher.add(job.compression);
+	hasher.add_bytes(data, size);
+	job.content_hash = hasher.get();
+	if (job.has_cached_hash && job.cached_hash == job.content_hash) {
+		job.up_to_date = true;
+		return;
+	}
+
+	PackedByteArray packed_buffer;
+	packed_buffer.resize(size);
+	memcpy(packed_buffer.ptrw(), data, size);
+
+	job.image = Image::create_from_data(width, height, false, Image::Format::FORMAT_RGBA8, packed_buffer);
+	if (job.compression == TextureCompression::None) {
+		job.png_error = job.image->save_png(job.png_path);
+	} else {
+		// Compressed textures skip the PNG copy, which is most of the
+		// disk usage we are trying to save
+		job.compress_error = compress_image(job.image, job.usage, job.compression);
+	}
+}
+
+void decode_texture(TextureJob &job) {
+	auto start = std::chrono::steady_clock::now();
+	if (job.texture) {
+		uint16_t width = 0;
+		uint16_t height = 0;
+		TList<uint8_t> buffer = Texture_GetDataT(job.texture, &width, &height);
+		decode_texture_data(job, buffer.data(), width, height);
+	} else if (job.pixels.size() >= (int64_t)job.width * job.height * 4) {
+		decode_texture_data(job, job.pixels.ptr(), job.width, job.height);
+	}
+	job.decode_usec = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+}
+
+void decode_textures(std::vector<TextureJob> &jobs, WorkerPool &pool) {
+	// PNG and block compression dominate, and are roughly proportional to
+	// texture size, so hand out one texture at a time rather than in chunks
+	pool.run(jobs.size(), [&](uint32_t i) {
+		decode_texture(jobs[i]);
+	});
+}
+
+}
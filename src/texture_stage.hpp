@@ -0,0 +1,65 @@
+#ifndef LVLIMPORT_TEXTURE_STAGE_HPP_
+#define LVLIMPORT_TEXTURE_STAGE_HPP_
+
+#include <godot_cpp/classes/image.hpp>
+#include <godot_cpp/variant/packed_byte_array.hpp>
+#include <godot_cpp/variant/string.hpp>
+#include <LibSWBF2/API.h>
+#include <vector>
+
+namespace godot {
+
+class WorkerPool;
+
+enum class TextureUsage {
+	Albedo,
+	TransparentAlbedo,
+	NormalMap,
+};
+
+enum class TextureCompression {
+	None, // Uncompressed RGBA8, plus a PNG copy
+	S3TC, // BC1/BC3/BC5, falling back to ETC2
+	ETC2,
+};
+
+// One texture to decode from LibSWBF2 and either write out as a PNG or
+// compress for the GPU. Jobs are independent of each other and touch no
+// importer state, so they can run on any thread. Jobs whose decoded source
+// hashes to cached_hash skip encoding entirely.
+struct TextureJob {
+	const LibSWBF2::Texture *texture = nullptr;
+	// RGBA8 source for jobs without a LibSWBF2 texture, e.g. synthetic
+	// fixtures
+	PackedByteArray pixels;
+	uint16_t width = 0;
+	uint16_t height = 0;
+	String name;
+	String png_path;
+	TextureUsage usage = TextureUsage::Albedo;
+	TextureCompression compression = TextureCompression::None;
+	bool has_cached_hash = false;
+	uint64_t cached_hash = 0; // Hash of the source the existing output was built from
+	uint64_t content_hash = 0;
+	bool up_to_date = false; // content_hash matched cached_hash; nothing was encoded
+	Ref<Image> image; // Null if the texture failed to decode or is up to date
+	Error png_error = Error::OK;
+	Error compress_error = Error::OK;
+	uint64_t decode_usec = 0; // Time spent in decode_texture
+};
+
+// Mipmaps the image and compresses it in place on the CPU:
+// - Normal maps become two channel BC5 (ETC2 RG11)
+// - Albedo with alpha becomes BC3 (ETC2 RGBA8) when the material is
+//   transparent or the alpha is a hard cutout
+// - Everything else drops its alpha and becomes BC1 (ETC2 RGB8)
+// If S3TC compression is unavailable we fall back to ETC2.
+Error compress_image(const Ref<Image> &image, TextureUsage usage, TextureCompression compression);
+
+void decode_texture(TextureJob &job);
+
+void decode_textures(std::vector<TextureJob> &jobs, WorkerPool &pool);
+
+}
+
+#endif
@@ -0,0 +1,56 @@
+#include "triangle_strip.hpp"
+
+namespace godot {
+
+// Walks every triangle of every strip, calling emit(v0, v1, v2) in output
+// winding order for each non-degenerate triangle
+template <typename Fn>
+static void walk_triangle_strips(const uint16_t *index, size_t count, Fn &&emit) {
+	uint32_t strip_length = 0;
+	bool clockwise = false;
+	uint16_t v0 = 0, v1 = 0;
+	for (size_t i = 0; i < count; ++ i) {
+		uint16_t v = index[i];
+		if (i + 1 < count && (v & index[i + 1]) & 0x8000) {
+			strip_length = 0;
+			clockwise = false;
+		}
+		uint16_t v2 = v & 0x7FFF;
+		if (strip_length >= 2) {
+			if (v0 != v1 && v1 != v2 && v0 != v2) {
+				if (clockwise) {
+					emit(v0, v1, v2);
+				} else {
+					emit(v0, v2, v1);
+				}
+			}
+			// Degenerate triangles still advance the strip's winding
+			clockwise = !clockwise;
+		}
+		v0 = v1;
+		v1 = v2;
+		strip_length += 1;
+	}
+}
+
+PackedInt32Array decode_triangle_strips(const uint16_t *index, size_t count) {
+	size_t triangle_count = 0;
+	walk_triangle_strips(index, count, [&](uint16_t, uint16_t, uint16_t) {
+		triangle_count += 1;
+	});
+
+	PackedInt32Array out;
+	out.resize(triangle_count * 3);
+	if (triangle_count == 0) {
+		return out;
+	}
+	int32_t *o = out.ptrw();
+	walk_triangle_strips(index, count, [&](uint16_t a, uint16_t b, uint16_t c) {
+		*o++ = a;
+		*o++ = b;
+		*o++ = c;
+	});
+	return out;
+}
+
+}
@@ -0,0 +1,20 @@
+#ifndef LVLIMPORT_TRIANGLE_STRIP_HPP_
+#define LVLIMPORT_TRIANGLE_STRIP_HPP_
+
+#include <godot_cpp/variant/packed_int32_array.hpp>
+#include <cstddef>
+#include <cstdint>
+
+namespace godot {
+
+// Converts SWBF2 triangle strips into a triangle list with Godot's winding.
+// From Chunks/MSH/STRP.cpp: two consecutive indices with the highest bit
+// set begin a new strip. Winding alternates along each strip starting
+// counter clockwise. Degenerate triangles, which strips use to stitch
+// themselves together, are dropped rather than emitted. The output is
+// counted first and then filled into an exactly sized array.
+PackedInt32Array decode_triangle_strips(const uint16_t *index, size_t count);
+
+}
+
+#endif
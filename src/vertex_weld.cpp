@@ -0,0 +1,156 @@
+#include "vertex_weld.hpp"
+#include "worker_pool.hpp"
+#include <godot_cpp/templates/hash_map.hpp>
+#include <cmath>
+#include <vector>
+
+namespace godot {
+
+static inline int64_t weld_cell_coord(real_t v, real_t inv_cell_size) {
+	return static_cast<int64_t>(std::floor(v * inv_cell_size));
+}
+
+static inline uint64_t weld_cell_key(int64_t x, int64_t y, int64_t z) {
+	// 21 bits per axis. Far away cells may alias, which only costs us
+	// a few extra distance tests; it never produces a wrong weld.
+	return ((static_cast<uint64_t>(x) & 0x1FFFFF) << 42) |
+	       ((static_cast<uint64_t>(y) & 0x1FFFFF) << 21) |
+	       ((static_cast<uint64_t>(z) & 0x1FFFFF));
+}
+
+WeldResult weld_indices(const Vector3 *vertices, uint32_t vertex_count, uint32_t *indices, uint32_t index_count, real_t tolerance, WorkerPool &pool) {
+	WeldResult result;
+	constexpr uint32_t NONE = UINT32_MAX;
+
+	const real_t tolerance_sq = tolerance * tolerance;
+	const real_t inv_cell_size = 1.0f / tolerance;
+
+	// Rank every referenced vertex by its first reference. Welding only
+	// ever moves a vertex onto a vertex of lower rank.
+	std::vector<uint32_t> rank(vertex_count, NONE);
+	std::vector<uint32_t> ranked;
+	for (uint32_t i = 0; i < index_count; ++ i) {
+		uint32_t vi = indices[i];
+		if (vi >= vertex_count) {
+			if (!result.index_errors) {
+				result.first_bad_index = vi;
+			}
+			result.index_errors = true;
+			continue;
+		}
+		if (rank[vi] == NONE) {
+			rank[vi] = ranked.size();
+			ranked.push_back(vi);
+		}
+	}
+	const uint32_t ranked_count = ranked.size();
+
+	// Bucket ranked vertices into tolerance sized cells. Chains are
+	// threaded through cell_next in descending rank.
+	std::vector<uint64_t> cell_key(ranked_count);
+	pool.parallel_for(ranked_count, [&](uint32_t, uint32_t begin, uint32_t end) {
+		for (uint32_t r = begin; r < end; ++ r) {
+			const Vector3 &v = vertices[ranked[r]];
+			cell_key[r] = weld_cell_key(weld_cell_coord(v.x, inv_cell_size), weld_cell_coord(v.y, inv_cell_size), weld_cell_coord(v.z, inv_cell_size));
+		}
+	});
+	HashMap<uint64_t, uint32_t> cell_heads;
+	std::vector<uint32_t> cell_next(ranked_count, NONE);
+	for (uint32_t r = 0; r < ranked_count; ++ r) {
+		if (uint32_t *head = cell_heads.getptr(cell_key[r])) {
+			cell_next[r] = *head;
+			*head = r;
+		} else {
+			cell_heads.insert(cell_key[r], r);
+		}
+	}
+
+	// Find every lower ranked vertex within tolerance of each vertex. This
+	// is the expensive part and is read only, so it runs in parallel.
+	// Neighbours are gathered per chunk and consumed in chunk order below.
+	struct NeighbourChunk {
+		std::vector<uint32_t> counts;
+		std::vector<uint32_t> neighbours;
+	};
+	std::vector<NeighbourChunk> chunks(pool.chunk_count(ranked_count));
+	pool.run(chunks.size(), [&](uint32_t chunk) {
+		uint32_t begin, end;
+		WorkerPool::chunk_range(ranked_count, chunks.size(), chunk, begin, end);
+		NeighbourChunk &nc = chunks[chunk];
+		nc.counts.resize(end - begin, 0);
+		for (uint32_t r = begin; r < end; ++ r) {
+			const Vector3 &v = vertices[ranked[r]];
+			int64_t cx = weld_cell_coord(v.x, inv_cell_size);
+			int64_t cy = weld_cell_coord(v.y, inv_cell_size);
+			int64_t cz = weld_cell_coord(v.z, inv_cell_size);
+			for (int64_t dx = -1; dx <= 1; ++ dx) {
+			for (int64_t dy = -1; dy <= 1; ++ dy) {
+			for (int64_t dz = -1; dz <= 1; ++ dz) {
+				const uint32_t *head = cell_heads.getptr(weld_cell_key(cx + dx, cy + dy, cz + dz));
+				if (head == nullptr) {
+					continue;
+				}
+				for (uint32_t n = *head; n != NONE; n = cell_next[n]) {
+					if (n >= r) {
+						continue;
+					}
+					if (vertices[ranked[n]].distance_squared_to(v) < tolerance_sq) {
+						nc.neighbours.push_back(n);
+						nc.counts[r - begin] += 1;
+					}
+				}
+			}}}
+		}
+	});
+
+	// Resolve welds in rank order. A vertex with no lower ranked leader in
+	// range becomes a leader itself; otherwise it is welded onto the lowest
+	// ranked leader in range. The old brute force pass rewrote each index
+	// to the first leader in range and never moved it again, since later
+	// leaders compared against that leader's position, not its own.
+	std::vector<uint32_t> target(ranked_count, NONE);
+	for (uint32_t chunk = 0, r = 0; chunk < chunks.size(); ++ chunk) {
+		const NeighbourChunk &nc = chunks[chunk];
+		const uint32_t *n = nc.neighbours.data();
+		for (uint32_t count : nc.counts) {
+			uint32_t best = NONE;
+			for (uint32_t k = 0; k < count; ++ k, ++ n) {
+				if (target[*n] == *n && (best == NONE || *n < best)) {
+					best = *n;
+				}
+			}
+			if (best == NONE) {
+				target[r] = r;
+			} else {
+				target[r] = best;
+				result.merged_vertices += 1;
+			}
+			r += 1;
+		}
+	}
+
+	// Rewrite the index buffer
+	std::vector<uint32_t> remapped(pool.chunk_count(index_count), 0);
+	pool.run(remapped.size(), [&](uint32_t chunk) {
+		uint32_t begin, end;
+		WorkerPool::chunk_range(index_count, remapped.size(), chunk, begin, end);
+		for (uint32_t i = begin; i < end; ++ i) {
+			uint32_t vi = indices[i];
+			if (vi >= vertex_count) {
+				continue;
+			}
+			uint32_t to = ranked[target[rank[vi]]];
+			if (to != vi) {
+				indices[i] = to;
+				remapped[chunk] += 1;
+			}
+		}
+	});
+	for (uint32_t count : remapped) {
+		result.remapped_indices += count;
+	}
+
+	return result;
+}
+
+}
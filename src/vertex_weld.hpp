@@ -0,0 +1,32 @@
+#ifndef LVLIMPORT_VERTEX_WELD_HPP_
+#define LVLIMPORT_VERTEX_WELD_HPP_
+
+#include <godot_cpp/variant/vector3.hpp>
+#include <cstdint>
+
+namespace godot {
+
+class WorkerPool;
+
+struct WeldResult {
+	uint32_t merged_vertices = 0;  // Distinct vertices remapped onto another vertex
+	uint32_t remapped_indices = 0; // Index buffer entries that were rewritten
+	bool index_errors = false;
+	uint32_t first_bad_index = 0;
+};
+
+// Rewrites indices in place so that every index referencing a vertex within
+// tolerance of an earlier referenced vertex points at that earlier vertex
+// instead. Vertices referenced first that are not themselves welded lead,
+// and each welded vertex goes to the earliest leader in range, so chains of
+// vertices each within tolerance of the next don't collapse onto one.
+// This is what the old brute force terrain pass did, but we bucket
+// vertices into a hash grid with tolerance sized cells so each vertex only
+// tests its 27 neighbouring cells rather than the whole buffer.
+// Each vertex is resolved once, at its first reference, so the output does
+// not depend on the number of threads in the pool.
+WeldResult weld_indices(const Vector3 *vertices, uint32_t vertex_count, uint32_t *indices, uint32_t index_count, real_t tolerance, WorkerPool &pool);
+
+}
+
+#endif
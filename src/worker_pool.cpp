@@ -0,0 +1,100 @@
+#include "worker_pool.hpp"
+#include <godot_cpp/classes/os.hpp>
+
+namespace godot {
+
+WorkerPool::WorkerPool(uint32_t thread_count) {
+	if (thread_count == 0) {
+		thread_count = OS::get_singleton()->get_processor_count();
+	}
+	if (thread_count == 0) {
+		thread_count = 1;
+	}
+	// The calling thread is the first worker
+	for (uint32_t i = 1; i < thread_count; ++ i) {
+		threads.emplace_back(&WorkerPool::worker_main, this);
+	}
+}
+
+WorkerPool::~WorkerPool() {
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		quit = true;
+	}
+	work_cv.notify_all();
+	for (std::thread &thread : threads) {
+		thread.join();
+	}
+}
+
+void WorkerPool::drain() {
+	for (uint32_t task = next_task.fetch_add(1); task < job_size; task = next_task.fetch_add(1)) {
+		(*job)(task);
+	}
+}
+
+void WorkerPool::worker_main() {
+	uint64_t seen_generation = 0;
+	for (;;) {
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			work_cv.wait(lock, [&] { return quit || generation != seen_generation; });
+			if (quit) {
+				return;
+			}
+			seen_generation = generation;
+		}
+		drain();
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			if (-- active == 0) {
+				done_cv.notify_one();
+			}
+		}
+	}
+}
+
+void WorkerPool::run(uint32_t task_count, const std::function<void(uint32_t)> &fn) {
+	if (task_count == 0) {
+		return;
+	}
+	if (threads.empty() || task_count == 1) {
+		for (uint32_t task = 0; task < task_count; ++ task) {
+			fn(task);
+		}
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		job = &fn;
+		job_size = task_count;
+		next_task = 0;
+		active = threads.size();
+		generation += 1;
+	}
+	work_cv.notify_all();
+
+	drain();
+
+	std::unique_lock<std::mutex> lock(mutex);
+	done_cv.wait(lock, [&] { return active == 0; });
+	job = nullptr;
+	job_size = 0;
+}
+
+uint32_t WorkerPool::chunk_count(uint32_t count, uint32_t min_chunk_size) const {
+	if (min_chunk_size == 0) {
+		min_chunk_size = 1;
+	}
+	// A few chunks per thread evens out uneven chunks without
+	// drowning small passes in scheduling overhead
+	uint64_t max_chunks = static_cast<uint64_t>(get_thread_count()) * 4;
+	uint64_t chunks = (static_cast<uint64_t>(count) + min_chunk_size - 1) / min_chunk_size;
+	if (chunks > max_chunks) {
+		chunks = max_chunks;
+	}
+	return chunks > 0 ? static_cast<uint32_t>(chunks) : 1;
+}
+
+}
@@ -0,0 +1,72 @@
+#ifndef LVLIMPORT_WORKER_POOL_HPP_
+#define LVLIMPORT_WORKER_POOL_HPP_
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace godot {
+
+// A fixed set of worker threads which cooperatively execute numbered tasks.
+// The calling thread participates in every run, so a pool of one thread
+// runs everything inline. Runs are not reentrant: do not call run() from
+// within a task.
+class WorkerPool {
+	std::vector<std::thread> threads;
+	std::mutex mutex;
+	std::condition_variable work_cv;
+	std::condition_variable done_cv;
+	const std::function<void(uint32_t)> *job = nullptr;
+	uint32_t job_size = 0;
+	std::atomic_uint32_t next_task = 0;
+	uint32_t active = 0;
+	uint64_t generation = 0;
+	bool quit = false;
+
+	void worker_main();
+	void drain();
+
+public:
+	// A thread_count of zero uses every processor
+	explicit WorkerPool(uint32_t thread_count);
+	~WorkerPool();
+
+	WorkerPool(const WorkerPool &) = delete;
+	WorkerPool &operator=(const WorkerPool &) = delete;
+
+	uint32_t get_thread_count() const { return threads.size() + 1; }
+
+	// Calls fn(task) for every task in [0, task_count) and returns once all
+	// tasks have completed.
+	void run(uint32_t task_count, const std::function<void(uint32_t)> &fn);
+
+	// Number of chunks [0, count) should be split into. Always at least one.
+	uint32_t chunk_count(uint32_t count, uint32_t min_chunk_size = 4096) const;
+
+	static void chunk_range(uint32_t count, uint32_t chunks, uint32_t chunk, uint32_t &begin, uint32_t &end) {
+		begin = static_cast<uint32_t>(static_cast<uint64_t>(count) * chunk / chunks);
+		end = static_cast<uint32_t>(static_cast<uint64_t>(count) * (chunk + 1) / chunks);
+	}
+
+	// Splits [0, count) into contiguous chunks and calls fn(chunk, begin, end)
+	// for each. Returns the number of chunks so callers may reduce per chunk
+	// results in chunk order.
+	template <typename Fn>
+	uint32_t parallel_for(uint32_t count, Fn &&fn, uint32_t min_chunk_size = 4096) {
+		uint32_t chunks = chunk_count(count, min_chunk_size);
+		run(chunks, [&](uint32_t chunk) {
+			uint32_t begin, end;
+			chunk_range(count, chunks, chunk, begin, end);
+			fn(chunk, begin, end);
+		});
+		return chunks;
+	}
+};
+
+}
+
+#endif
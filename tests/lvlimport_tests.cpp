@@ -0,0 +1,43 @@
+#include "lvlimport_tests.hpp"
+#include "test_check.hpp"
+#include <godot_cpp/variant/utility_functions.hpp>
+#include <atomic>
+
+namespace godot {
+
+void test_normal_kernel();
+void test_triangle_strip();
+void test_vertex_weld();
+
+static std::atomic_uint32_t failures = 0;
+
+void test_fail(const char *file, int line, const char *expression) {
+	failures += 1;
+	UtilityFunctions::printerr(file, ":", line, ": CHECK(", expression, ") failed");
+}
+
+void LVLImportTests::_bind_methods() {
+	godot::ClassDB::bind_method(godot::D_METHOD("run"), &LVLImportTests::run);
+}
+
+int64_t LVLImportTests::run() {
+	struct Test {
+		const char *name;
+		void (*fn)();
+	};
+	static const Test tests[] = {
+		{ "normal_kernel", test_normal_kernel },
+		{ "triangle_strip", test_triangle_strip },
+		{ "vertex_weld", test_vertex_weld },
+	};
+
+	uint32_t start_failures = failures;
+	for (const Test &test : tests) {
+		uint32_t before = failures;
+		test.fn();
+		UtilityFunctions::print(test.name, failures == before ? ": ok" : ": FAILED");
+	}
+	return failures - start_failures;
+}
+
+}
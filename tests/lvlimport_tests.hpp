@@ -0,0 +1,24 @@
+#ifndef LVLIMPORT_LVLIMPORT_TESTS_HPP_
+#define LVLIMPORT_LVLIMPORT_TESTS_HPP_
+
+#include <godot_cpp/classes/ref_counted.hpp>
+
+namespace godot {
+
+// Runs the C++ tests in tests/ from inside the engine, since most of the
+// importer works on Godot types. Only compiled into the library by
+// "scons test", see demo/tests.gd.
+class LVLImportTests : public RefCounted {
+	GDCLASS(LVLImportTests, RefCounted)
+
+protected:
+	static void _bind_methods();
+
+public:
+	// Returns the number of failed checks
+	int64_t run();
+};
+
+}
+
+#endif
@@ -0,0 +1,18 @@
+#ifndef LVLIMPORT_TEST_CHECK_HPP_
+#define LVLIMPORT_TEST_CHECK_HPP_
+
+namespace godot {
+
+// Prints a failed check and counts it towards LVLImportTests.run()
+void test_fail(const char *file, int line, const char *expression);
+
+}
+
+#define CHECK(expression) \
+	do { \
+		if (!(expression)) { \
+			::godot::test_fail(__FILE__, __LINE__, #expression); \
+		} \
+	} while (0)
+
+#endif
@@ -0,0 +1,117 @@
+#include "normal_kernel.hpp"
+#include "test_check.hpp"
+#include <godot_cpp/variant/vector3.hpp>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <vector>
+
+namespace godot {
+
+// Bit identical, except that any NaN matches any other
+static bool same_float(float a, float b) {
+	if (std::isnan(a) || std::isnan(b)) {
+		return std::isnan(a) && std::isnan(b);
+	}
+	return std::memcmp(&a, &b, sizeof(float)) == 0;
+}
+
+static bool same_vector(float x, float y, float z, const Vector3 &v) {
+	return same_float(x, v.x) && same_float(y, v.y) && same_float(z, v.z);
+}
+
+void test_normal_kernel() {
+	const float nan = std::numeric_limits<float>::quiet_NaN();
+	const float inf = std::numeric_limits<float>::infinity();
+
+	// Random positions, followed by ones whose normals hit the kernels'
+	// special cases
+	std::vector<float> x, y, z;
+	uint32_t seed = 12345;
+	auto random = [&]() {
+		seed = seed * 1664525u + 1013904223u;
+		return (float)(seed >> 8) / (float)(1 << 24) * 200.0f - 100.0f;
+	};
+	for (int i = 0; i < 64; ++ i) {
+		x.push_back(random());
+		y.push_back(random());
+		z.push_back(random());
+	}
+	const float special[][3] = {
+		{ nan, 0, 0 }, { 0, nan, 1 }, { inf, 0, 0 }, { -inf, 1, 0 },
+		{ 1e-30f, 0, 0 }, { 0, 1e-30f, 0 }, { 0, 0, 1e-30f }, // Length squared underflows to zero
+		{ 1e-20f, 0, 0 }, { 0, 1e-20f, 0 }, // Length squared is denormal
+		{ 1e20f, 0, 0 }, { 0, 1e20f, 0 }, // Length squared overflows
+	};
+	for (const float *p : special) {
+		x.push_back(p[0]);
+		y.push_back(p[1]);
+		z.push_back(p[2]);
+	}
+	const int32_t vertex_count = x.size();
+	const int32_t first_special = 64;
+
+	// Several blocks of kernel width plus a scalar tail. Besides random
+	// triangles there are degenerate ones, ones touching each special
+	// position, and tiny, denormal and huge ones at the origin.
+	std::vector<int32_t> index;
+	for (int32_t t = 0; t < 40; ++ t) {
+		index.push_back(t);
+		index.push_back(t + 7);
+		index.push_back(t + 13);
+	}
+	index.insert(index.end(), { 3, 3, 9,  5, 5, 5 });
+	for (int32_t s = first_special; s < vertex_count; ++ s) {
+		index.insert(index.end(), { s, 1, 2,  0, s, 2 });
+	}
+	index.insert(index.end(), { first_special + 4, first_special + 5, first_special + 6 });
+	index.insert(index.end(), { first_special + 7, first_special + 8, first_special + 6 });
+	index.insert(index.end(), { first_special + 9, first_special + 10, first_special + 6 });
+	const uint32_t triangle_count = index.size() / 3;
+	CHECK(triangle_count % NORMAL_KERNEL_WIDTH != 0);
+
+	// One call over every triangle takes the vectorized path for all but the
+	// tail, while one call per triangle always takes the scalar path. Both
+	// must match Vector3, which they claim to be bit identical to.
+	std::vector<float> nx(triangle_count), ny(triangle_count), nz(triangle_count);
+	std::vector<float> sx(triangle_count), sy(triangle_count), sz(triangle_count);
+	compute_face_normals(x.data(), y.data(), z.data(), index.data(), 0, triangle_count, nx.data(), ny.data(), nz.data());
+	for (uint32_t t = 0; t < triangle_count; ++ t) {
+		compute_face_normals(x.data(), y.data(), z.data(), index.data(), t, t + 1, sx.data(), sy.data(), sz.data());
+	}
+	for (uint32_t t = 0; t < triangle_count; ++ t) {
+		const int32_t *tri = index.data() + t * 3;
+		Vector3 v0(x[tri[0]], y[tri[0]], z[tri[0]]);
+		Vector3 v1(x[tri[1]], y[tri[1]], z[tri[1]]);
+		Vector3 v2(x[tri[2]], y[tri[2]], z[tri[2]]);
+		Vector3 expected = (v1 - v0).cross(v2 - v0).normalized();
+		CHECK(same_vector(nx[t], ny[t], nz[t], Vector3(sx[t], sy[t], sz[t])));
+		CHECK(same_vector(nx[t], ny[t], nz[t], expected));
+	}
+
+	// The same for normalizing vectors in place, starting with the face
+	// normals' raw cross products
+	std::vector<float> cx(triangle_count), cy(triangle_count), cz(triangle_count);
+	for (uint32_t t = 0; t < triangle_count; ++ t) {
+		const int32_t *tri = index.data() + t * 3;
+		Vector3 v0(x[tri[0]], y[tri[0]], z[tri[0]]);
+		Vector3 c = (Vector3(x[tri[1]], y[tri[1]], z[tri[1]]) - v0).cross(Vector3(x[tri[2]], y[tri[2]], z[tri[2]]) - v0);
+		cx[t] = c.x;
+		cy[t] = c.y;
+		cz[t] = c.z;
+	}
+	std::vector<float> vx(cx), vy(cy), vz(cz);
+	normalize_vectors(vx.data(), vy.data(), vz.data(), 0, triangle_count);
+	sx = cx;
+	sy = cy;
+	sz = cz;
+	for (uint32_t t = 0; t < triangle_count; ++ t) {
+		normalize_vectors(sx.data(), sy.data(), sz.data(), t, t + 1);
+	}
+	for (uint32_t t = 0; t < triangle_count; ++ t) {
+		CHECK(same_vector(vx[t], vy[t], vz[t], Vector3(sx[t], sy[t], sz[t])));
+		CHECK(same_vector(vx[t], vy[t], vz[t], Vector3(cx[t], cy[t], cz[t]).normalized()));
+	}
+}
+
+}
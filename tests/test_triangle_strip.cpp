@@ -0,0 +1,56 @@
+#include "test_check.hpp"
+#include "triangle_strip.hpp"
+#include <initializer_list>
+#include <vector>
+
+namespace godot {
+
+static constexpr uint16_t R = 0x8000; // Strip restart flag
+
+static bool decodes_to(std::initializer_list<uint16_t> strip, std::initializer_list<int32_t> triangles) {
+	std::vector<uint16_t> index(strip);
+	PackedInt32Array out = decode_triangle_strips(index.data(), index.size());
+	if ((size_t)out.size() != triangles.size()) {
+		return false;
+	}
+	size_t i = 0;
+	for (int32_t expected : triangles) {
+		if (out[i++] != expected) {
+			return false;
+		}
+	}
+	return true;
+}
+
+void test_triangle_strip() {
+	// Too short for a triangle
+	CHECK(decodes_to({}, {}));
+	CHECK(decodes_to({ 0 | R, 1 | R }, {}));
+
+	// Winding alternates starting counter clockwise, which Godot's
+	// clockwise front faces flip to v0, v2, v1
+	CHECK(decodes_to({ 0 | R, 1 | R, 2, 3, 4 }, { 0, 2, 1,  1, 2, 3,  2, 4, 3 }));
+
+	// Two consecutive flagged indices restart the strip, so no triangle
+	// spans the restart and the new strip starts counter clockwise again.
+	// Its first triangle would be clockwise without the restart.
+	CHECK(decodes_to({ 0 | R, 1 | R, 2, 3 | R, 4 | R, 5 }, { 0, 2, 1,  3, 5, 4 }));
+
+	// A single flagged index is just an index
+	CHECK(decodes_to({ 0 | R, 1 | R, 2, 3 | R, 4, 5 }, { 0, 2, 1,  1, 2, 3,  2, 4, 3,  3, 4, 5 }));
+
+	// A flagged pair at the end restarts a strip too short to emit anything
+	CHECK(decodes_to({ 0 | R, 1 | R, 2, 3 | R, 4 | R }, { 0, 2, 1 }));
+
+	// Degenerate triangles are dropped but still advance the winding: the
+	// third triangle is counter clockwise whether or not the second is
+	// emitted
+	CHECK(decodes_to({ 0 | R, 1 | R, 2, 1, 3 }, { 0, 2, 1,  2, 3, 1 }));
+	CHECK(decodes_to({ 0 | R, 1 | R, 2, 2, 3, 4 }, { 0, 2, 1,  2, 3, 4 }));
+
+	// Stitching two strips with repeated indices instead of restarts
+	// emits only their real triangles with their own winding
+	CHECK(decodes_to({ 0 | R, 1 | R, 2, 3, 3, 4, 4, 5, 6 }, { 0, 2, 1,  1, 2, 3,  4, 6, 5 }));
+}
+
+}
@@ -0,0 +1,89 @@
+#include "test_check.hpp"
+#include "vertex_weld.hpp"
+#include "worker_pool.hpp"
+#include <godot_cpp/variant/vector3.hpp>
+#include <vector>
+
+namespace godot {
+
+// The brute force pass vertex_weld replaced: each index not yet rewritten
+// pulls every later index within tolerance onto its own vertex
+static std::vector<uint32_t> reference_weld(const std::vector<Vector3> &vertices, std::vector<uint32_t> indices, real_t tolerance) {
+	std::vector<bool> visited(indices.size(), false);
+	for (size_t i = 0; i < indices.size(); ++ i) {
+		if (visited[i]) {
+			continue;
+		}
+		for (size_t j = i + 1; j < indices.size(); ++ j) {
+			if (vertices[indices[i]].distance_squared_to(vertices[indices[j]]) < tolerance * tolerance) {
+				indices[j] = indices[i];
+				visited[j] = true;
+			}
+		}
+	}
+	return indices;
+}
+
+static bool welds_like_reference(const std::vector<Vector3> &vertices, const std::vector<uint32_t> &indices, real_t tolerance, WorkerPool &pool) {
+	std::vector<uint32_t> welded = indices;
+	weld_indices(vertices.data(), vertices.size(), welded.data(), welded.size(), tolerance, pool);
+	return welded == reference_weld(vertices, indices, tolerance);
+}
+
+void test_vertex_weld() {
+	WorkerPool single(1);
+	WorkerPool pool(4);
+
+	// A chain: 2 is in range of both leaders and must go to the first
+	std::vector<Vector3> chain = { Vector3(0, 0, 0), Vector3(0.16f, 0, 0), Vector3(0.08f, 0, 0) };
+	std::vector<uint32_t> welded = { 0, 1, 2 };
+	WeldResult result = weld_indices(chain.data(), chain.size(), welded.data(), welded.size(), 0.1f, single);
+	CHECK((welded == std::vector<uint32_t>{ 0, 1, 0 }));
+	CHECK(result.merged_vertices == 1);
+	CHECK(result.remapped_indices == 1);
+	CHECK(welds_like_reference(chain, { 2, 1, 0 }, 0.1f, single));
+	CHECK(welds_like_reference(chain, { 1, 2, 0, 2, 1 }, 0.1f, single));
+
+	// Longer chains along each axis, in either direction, with vertices
+	// referenced out of order and repeatedly
+	for (int axis = 0; axis < 3; ++ axis) {
+		std::vector<Vector3> vertices;
+		for (int i = 0; i < 16; ++ i) {
+			Vector3 v;
+			v[axis] = (i % 2 ? 16 - i : i) * 0.06f;
+			vertices.push_back(v);
+		}
+		std::vector<uint32_t> indices;
+		for (uint32_t i = 0; i < 48; ++ i) {
+			indices.push_back((i * 7) % vertices.size());
+		}
+		CHECK(welds_like_reference(vertices, indices, 0.1f, single));
+		CHECK(welds_like_reference(vertices, indices, 0.1f, pool));
+	}
+
+	// Random clusters, large enough to be split across the pool's threads
+	std::vector<Vector3> vertices;
+	uint32_t seed = 54321;
+	auto random = [&]() {
+		seed = seed * 1664525u + 1013904223u;
+		return (real_t)(seed >> 8) / (real_t)(1 << 24);
+	};
+	for (int i = 0; i < 3000; ++ i) {
+		vertices.push_back(Vector3(random() * 4.0f, random() * 0.2f, random() * 4.0f));
+	}
+	std::vector<uint32_t> indices;
+	for (int i = 0; i < 9000; ++ i) {
+		indices.push_back((uint32_t)(random() * vertices.size()));
+	}
+	CHECK(welds_like_reference(vertices, indices, 0.1f, single));
+	CHECK(welds_like_reference(vertices, indices, 0.1f, pool));
+
+	// Out of range indices are reported and left alone
+	std::vector<uint32_t> bad = { 0, 7, 2 };
+	result = weld_indices(chain.data(), chain.size(), bad.data(), bad.size(), 0.1f, single);
+	CHECK(result.index_errors);
+	CHECK(result.first_bad_index == 7);
+	CHECK((bad == std::vector<uint32_t>{ 0, 7, 0 }));
+}
+
+}